@@ -41,52 +41,70 @@ class EventBind : public ElunaBind
 {
 public:
     typedef std::vector<int> ElunaBindingMap;
-    typedef std::map<int, ElunaBindingMap> ElunaEntryMap;
+    typedef std::vector<ElunaBindingMap> ElunaEntryMap;
 
-    EventBind(const char* bindGroupName, Eluna& _E) : ElunaBind(bindGroupName, _E)
+    EventBind(const char* bindGroupName, Eluna& _E) : ElunaBind(bindGroupName, _E), eventMask(0), generation(0)
     {
     }
 
-    // unregisters all registered functions and clears all registered events from the bind std::maps (reset)
+    // unregisters all registered functions and clears all registered events from the bindings (reset)
     void Clear() override
     {
         for (ElunaEntryMap::iterator itr = Bindings.begin(); itr != Bindings.end(); ++itr)
         {
-            for (ElunaBindingMap::iterator it = itr->second.begin(); it != itr->second.end(); ++it)
+            for (ElunaBindingMap::iterator it = itr->begin(); it != itr->end(); ++it)
                 luaL_unref(E.L, LUA_REGISTRYINDEX, (*it));
-            itr->second.clear();
+            itr->clear();
         }
         Bindings.clear();
+        eventMask = 0;
+        ++generation;
     }
 
     void Insert(int eventId, int funcRef) // Inserts a new registered event
     {
+        // all event enums fit in the mask, Eluna::Register checks the upper bound
+        ASSERT(eventId >= 0 && eventId < 64);
+        if (size_t(eventId) >= Bindings.size())
+            Bindings.resize(eventId + 1);
         Bindings[eventId].push_back(funcRef);
+        eventMask |= uint64(1) << eventId;
+        ++generation;
     }
 
-    // Gets the binding std::map containing all registered events with the function refs for the entry
+    // Removes a registered event without freeing the function ref
+    void Remove(int eventId, int funcRef)
+    {
+        if (size_t(eventId) >= Bindings.size())
+            return;
+        ElunaBindingMap& binds = Bindings[eventId];
+        ElunaBindingMap::iterator it = std::find(binds.begin(), binds.end(), funcRef);
+        if (it != binds.end())
+        {
+            binds.erase(it);
+            ++generation;
+        }
+        if (binds.empty())
+            eventMask &= ~(uint64(1) << eventId);
+    }
+
+    // Gets the function refs registered for the event in registration order
     ElunaBindingMap* GetBindMap(T eventId)
     {
-        if (Bindings.empty())
-            return NULL;
-        ElunaEntryMap::iterator itr = Bindings.find(eventId);
-        if (itr == Bindings.end())
+        if (!HasEvents(eventId))
             return NULL;
-
-        return &itr->second;
+        return &Bindings[eventId];
     }
 
     // Checks if there are events for ID
     bool HasEvents(T eventId) const
     {
-        if (Bindings.empty())
-            return false;
-        if (Bindings.find(eventId) == Bindings.end())
-            return false;
-        return true;
+        return (eventMask & (uint64(1) << eventId)) != 0;
     }
 
     ElunaEntryMap Bindings; // Binding store Bindings[eventId] = {funcRef};
+    uint64 eventMask;       // bit eventId is set when Bindings[eventId] is not empty
+    uint32 generation;      // changes whenever a binding is added or removed
 };
 
 template<typename T>
@@ -123,6 +141,20 @@ public:
             Bindings[entryId][eventId] = funcRef;
     }
 
+    // Removes a registered event without freeing the function ref
+    void Remove(uint32 entryId, int eventId, int funcRef)
+    {
+        ElunaEntryMap::iterator itr = Bindings.find(entryId);
+        if (itr == Bindings.end())
+            return;
+        ElunaBindingMap::iterator it = itr->second.find(eventId);
+        if (it != itr->second.end() && it->second == funcRef)
+            itr->second.erase(it);
+        // entries without binds must not get lua AI
+        if (itr->second.empty())
+            Bindings.erase(itr);
+    }
+
     // Gets the function ref of an entry for an event
     int GetBind(uint32 entryId, T eventId) const
     {
@@ -6,6 +6,7 @@
 
 #include "ElunaEventMgr.h"
 #include "LuaEngine.h"
+#include "ElunaProfiler.h"
 #include "Object.h"
 
 extern "C"
@@ -14,8 +15,8 @@ extern "C"
 #include "lauxlib.h"
 };
 
-LuaEvent::LuaEvent(ElunaEventProcessor* _events, int _funcRef, uint32 _delay, uint32 _calls) :
-to_Abort(false), events(_events), funcRef(_funcRef), delay(_delay), calls(_calls)
+LuaEvent::LuaEvent(ElunaEventProcessor* _events, int _funcRef, uint32 _delay, uint32 _calls, uint32 _owner) :
+to_Abort(false), events(_events), funcRef(_funcRef), delay(_delay), calls(_calls), owner(_owner)
 {
 }
 
@@ -34,6 +35,7 @@ void LuaEvent::Execute()
     if (calls) // Must be before calling
         --calls;
     Eluna::Push(sEluna->L, events->obj);
+    ElunaProfiler::HookTimer timer(sEluna->profiler, "TimedEvents", 0, 0, funcRef);
     Eluna::ExecuteCall(sEluna->L, 4, 0);
 }
 
@@ -106,15 +108,22 @@ void ElunaEventProcessor::RemoveEvent(int eventId)
         eventMap[eventId]->to_Abort = true;
 }
 
+void ElunaEventProcessor::RemoveOwnedEvents(uint32 owner)
+{
+    for (EventList::iterator it = eventList.begin(); it != eventList.end(); ++it)
+        if (it->second->owner == owner)
+            it->second->to_Abort = true;
+}
+
 void ElunaEventProcessor::AddEvent(LuaEvent* event)
 {
     eventList.insert(std::pair<uint64, LuaEvent*>(m_time + event->delay, event));
     eventMap[event->funcRef] = event;
 }
 
-void ElunaEventProcessor::AddEvent(int funcRef, uint32 delay, uint32 repeats)
+void ElunaEventProcessor::AddEvent(int funcRef, uint32 delay, uint32 repeats, uint32 owner)
 {
-    AddEvent(new LuaEvent(this, funcRef, delay, repeats));
+    AddEvent(new LuaEvent(this, funcRef, delay, repeats, owner));
 }
 
 EventMgr::EventMgr() : globalProcessor(NULL)
@@ -144,3 +153,12 @@ void EventMgr::RemoveEvent(int eventId)
             (*it)->RemoveEvent(eventId);
     globalProcessor->RemoveEvent(eventId);
 }
+
+void EventMgr::RemoveOwnedEvents(uint32 owner)
+{
+    ReadGuard lock(GetLock());
+    if (!processors.empty())
+        for (ProcessorSet::const_iterator it = processors.begin(); it != processors.end(); ++it) // loop processors
+            (*it)->RemoveOwnedEvents(owner);
+    globalProcessor->RemoveOwnedEvents(owner);
+}
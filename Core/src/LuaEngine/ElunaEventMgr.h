@@ -32,13 +32,14 @@ public:
     bool to_Abort;
 
 private:
-    LuaEvent(ElunaEventProcessor* _events, int _funcRef, uint32 _delay, uint32 _calls);
+    LuaEvent(ElunaEventProcessor* _events, int _funcRef, uint32 _delay, uint32 _calls, uint32 _owner);
     ~LuaEvent();
 
     ElunaEventProcessor* events; // Pointer to events (holds the timed event)
     int funcRef;    // Lua function reference ID, also used as event ID
     uint32 delay;   // Delay between event calls
     uint32 calls;   // Amount of calls to make, 0 for infinite
+    uint32 owner;   // Load id of the script file that created the event, 0 if created at runtime
 };
 
 class ElunaEventProcessor
@@ -57,7 +58,9 @@ public:
     void RemoveEvents();
     // set the event to be removed when executing
     void RemoveEvent(int eventId);
-    void AddEvent(int funcRef, uint32 delay, uint32 repeats);
+    // set the events created by the script load to be removed when executing
+    void RemoveOwnedEvents(uint32 owner);
+    void AddEvent(int funcRef, uint32 delay, uint32 repeats, uint32 owner = 0);
     EventMap eventMap;
 
 private:
@@ -84,6 +87,10 @@ public:
     // Removes the eventId from all events
     // Execute only in safe env
     void RemoveEvent(int eventId);
+
+    // Removes the events created by the script load from all events
+    // Execute only in safe env
+    void RemoveOwnedEvents(uint32 owner);
 };
 
 #endif
@@ -0,0 +1,262 @@
+/*
+* Copyright (C) 2010 - 2014 Eluna Lua Engine <http://emudevs.com/>
+* This program is free software licensed under GPL version 3
+* Please see the included DOCS/LICENSE.md for more information
+*/
+
+#include "ElunaProfiler.h"
+#include "LuaEngine.h"
+#include "ElunaIncludes.h"
+
+#include <algorithm>
+#include <fstream>
+
+extern "C"
+{
+#include "lua.h"
+#include "lauxlib.h"
+};
+
+// Deepest Lua stack recorded for a single sample
+#define PROFILER_MAX_STACK_DEPTH    64
+#define PROFILER_DEFAULT_INTERVAL   1000
+#define PROFILER_DEFAULT_DUMP_FILE  "eluna_profile.folded"
+
+bool ElunaProfiler::HookKey::operator<(HookKey const& other) const
+{
+    if (group != other.group)
+        return group < other.group;
+    if (event != other.event)
+        return event < other.event;
+    if (entry != other.entry)
+        return entry < other.entry;
+    return funcRef < other.funcRef;
+}
+
+ElunaProfiler::HookTimer::HookTimer(ElunaProfiler* profiler, const char* group, uint32 event, uint32 entry, int funcRef) :
+prof(profiler && profiler->enabled ? profiler : NULL), prevHook(NULL)
+{
+    if (!prof)
+        return;
+
+    key.group = group;
+    key.event = event;
+    key.entry = entry;
+    key.funcRef = funcRef;
+    prevHook = prof->currentHook;
+    prof->currentHook = &key;
+    start = Clock::now();
+}
+
+ElunaProfiler::HookTimer::~HookTimer()
+{
+    if (!prof)
+        return;
+
+    uint64 elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    prof->currentHook = prevHook;
+
+    // the profiler may have been stopped or reset from inside the hook
+    if (!prof->enabled)
+        return;
+
+    HookStats& stats = prof->hookStats[key];
+    ++stats.calls;
+    stats.totalUs += elapsed;
+    if (elapsed > stats.maxUs)
+        stats.maxUs = elapsed;
+}
+
+ElunaProfiler::ElunaProfiler(lua_State* _L) : L(_L), enabled(false), sampleInterval(0), sampleCount(0), currentHook(NULL)
+{
+}
+
+ElunaProfiler::~ElunaProfiler()
+{
+    Stop();
+}
+
+void ElunaProfiler::Start(uint32 interval)
+{
+    enabled = true;
+    sampleInterval = interval;
+    if (sampleInterval)
+        lua_sethook(L, &ElunaProfiler::SampleHook, LUA_MASKCOUNT, sampleInterval);
+    else
+        lua_sethook(L, NULL, 0, 0);
+}
+
+void ElunaProfiler::Stop()
+{
+    enabled = false;
+    lua_sethook(L, NULL, 0, 0);
+}
+
+void ElunaProfiler::Reset()
+{
+    hookStats.clear();
+    stackSamples.clear();
+    sampleCount = 0;
+}
+
+void ElunaProfiler::SampleHook(lua_State* L, lua_Debug* /*ar*/)
+{
+    if (sEluna && sEluna->profiler)
+        sEluna->profiler->RecordSample(L);
+}
+
+void ElunaProfiler::RecordSample(lua_State* L)
+{
+    if (!enabled)
+        return;
+
+    std::vector<std::string> frames;
+    lua_Debug frame;
+    for (int level = 0; level < PROFILER_MAX_STACK_DEPTH && lua_getstack(L, level, &frame); ++level)
+    {
+        if (!lua_getinfo(L, "Sn", &frame))
+            continue;
+
+        std::ostringstream ss;
+        ss << (frame.name ? frame.name : (*frame.what == 'm' ? "main" : "?"));
+        if (*frame.what != 'C')
+            ss << " (" << frame.short_src << ":" << frame.linedefined << ")";
+        frames.push_back(ss.str());
+    }
+
+    std::string stack = currentHook ? FormatHook(*currentHook) : "(no hook)";
+    for (std::vector<std::string>::const_reverse_iterator it = frames.rbegin(); it != frames.rend(); ++it)
+        stack += ";" + *it;
+
+    // ';' separates frames and the last space separates the count in folded stacks
+    std::replace(stack.begin(), stack.end(), '\n', ' ');
+    ++stackSamples[stack];
+    ++sampleCount;
+}
+
+std::string ElunaProfiler::FormatHook(HookKey const& key)
+{
+    std::ostringstream ss;
+    ss << key.group << " event " << key.event;
+    if (key.entry)
+        ss << " entry " << key.entry;
+    return ss.str();
+}
+
+std::string ElunaProfiler::DescribeRef(int funcRef) const
+{
+    lua_rawgeti(L, LUA_REGISTRYINDEX, funcRef);
+    if (!lua_isfunction(L, -1))
+    {
+        lua_pop(L, 1);
+        return "?";
+    }
+
+    lua_Debug ar;
+    lua_getinfo(L, ">S", &ar); // pops the function
+    std::ostringstream ss;
+    ss << "ref " << funcRef << " (" << ar.short_src << ":" << ar.linedefined << ")";
+    return ss.str();
+}
+
+bool ElunaProfiler::DumpFolded(std::string const& path) const
+{
+    std::ofstream samples(path.c_str(), std::ios::out | std::ios::trunc);
+    if (!samples)
+        return false;
+    for (StackSampleMap::const_iterator it = stackSamples.begin(); it != stackSamples.end(); ++it)
+        samples << it->first << ' ' << it->second << '\n';
+
+    std::ofstream hooks((path + ".hooks").c_str(), std::ios::out | std::ios::trunc);
+    if (!hooks)
+        return false;
+    for (HookStatsMap::const_iterator it = hookStats.begin(); it != hookStats.end(); ++it)
+    {
+        std::string frame = DescribeRef(it->first.funcRef);
+        std::replace(frame.begin(), frame.end(), ';', ':');
+        hooks << FormatHook(it->first) << ';' << frame << ' ' << it->second.totalUs << '\n';
+    }
+    return true;
+}
+
+static bool HookTotalTimeComparator(ElunaProfiler::HookStatsMap::const_iterator const& first, ElunaProfiler::HookStatsMap::const_iterator const& second)
+{
+    return first->second.totalUs > second->second.totalUs;
+}
+
+static void SendProfilerMessage(Player* player, std::string const& msg)
+{
+    if (player)
+        ChatHandler(player->GetSession()).SendSysMessage(msg.c_str());
+    else
+        ELUNA_LOG_INFO("[Eluna]: %s", msg.c_str());
+}
+
+bool ElunaProfiler::HandleCommand(Player* player, std::string const& args)
+{
+    std::istringstream in(args);
+    std::string command, subcommand;
+    in >> command >> subcommand;
+    std::transform(command.begin(), command.end(), command.begin(), ::tolower);
+    std::transform(subcommand.begin(), subcommand.end(), subcommand.begin(), ::tolower);
+    if (command != "profile" || !sEluna)
+        return false;
+
+    ElunaProfiler* prof = sEluna->profiler;
+    std::ostringstream out;
+    if (subcommand == "start")
+    {
+        uint32 interval = PROFILER_DEFAULT_INTERVAL;
+        in >> interval;
+        prof->Start(interval);
+        out << "Eluna profiler started, sampling every " << interval << " instructions";
+    }
+    else if (subcommand == "stop")
+    {
+        prof->Stop();
+        out << "Eluna profiler stopped, " << prof->GetSampleCount() << " samples collected";
+    }
+    else if (subcommand == "reset")
+    {
+        prof->Reset();
+        out << "Eluna profiler data cleared";
+    }
+    else if (subcommand == "dump")
+    {
+        std::string path = PROFILER_DEFAULT_DUMP_FILE;
+        in >> path;
+        if (prof->DumpFolded(path))
+            out << "Eluna profile written to " << path << " and " << path << ".hooks";
+        else
+            out << "Could not write Eluna profile to " << path;
+    }
+    else if (subcommand == "show")
+    {
+        uint32 count = 10;
+        in >> count;
+
+        std::vector<HookStatsMap::const_iterator> sorted;
+        for (HookStatsMap::const_iterator it = prof->GetHookStats().begin(); it != prof->GetHookStats().end(); ++it)
+            sorted.push_back(it);
+        std::sort(sorted.begin(), sorted.end(), HookTotalTimeComparator);
+        if (sorted.size() > count)
+            sorted.resize(count);
+
+        SendProfilerMessage(player, prof->IsEnabled() ? "Eluna profiler is running" : "Eluna profiler is stopped");
+        for (std::vector<HookStatsMap::const_iterator>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+        {
+            HookStats const& stats = (*it)->second;
+            std::ostringstream line;
+            line << FormatHook((*it)->first) << " " << prof->DescribeRef((*it)->first.funcRef)
+                << ": calls " << stats.calls << ", total " << stats.totalUs << " us, avg "
+                << (stats.calls ? stats.totalUs / stats.calls : 0) << " us, max " << stats.maxUs << " us";
+            SendProfilerMessage(player, line.str());
+        }
+        return true;
+    }
+    else
+        out << "Usage: .eluna profile start [sampleInterval] | stop | reset | show [count] | dump [file]";
+
+    SendProfilerMessage(player, out.str());
+    return true;
+}
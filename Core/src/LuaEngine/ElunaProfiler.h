@@ -0,0 +1,104 @@
+/*
+* Copyright (C) 2010 - 2014 Eluna Lua Engine <http://emudevs.com/>
+* This program is free software licensed under GPL version 3
+* Please see the included DOCS/LICENSE.md for more information
+*/
+
+#ifndef _ELUNA_PROFILER_H
+#define _ELUNA_PROFILER_H
+
+#include "Common.h"
+#include "ElunaUtility.h"
+#include <chrono>
+#include <map>
+
+struct lua_State;
+struct lua_Debug;
+class Player;
+
+/*
+ * Measures the wall time spent in every registered hook and optionally samples
+ * the Lua call stack every N VM instructions through lua_sethook.
+ *
+ * Hook timing is keyed by bind group, event, entry and function reference.
+ * Samples are attributed to the hook that was executing and can be dumped in
+ * folded-stack format (one "frame;frame;frame count" line per unique stack),
+ * which is the input format of flamegraph.pl.
+ */
+class ElunaProfiler
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct HookKey
+    {
+        const char* group;  // bind group name, owned by the binding store
+        uint32 event;
+        uint32 entry;       // 0 for event binds
+        int funcRef;
+
+        bool operator<(HookKey const& other) const;
+    };
+
+    struct HookStats
+    {
+        HookStats() : calls(0), totalUs(0), maxUs(0) { }
+
+        uint64 calls;
+        uint64 totalUs;
+        uint64 maxUs;
+    };
+
+    typedef std::map<HookKey, HookStats> HookStatsMap;
+    typedef UNORDERED_MAP<std::string, uint64> StackSampleMap;
+
+    // Times one hook call for as long as it is in scope. Does nothing when the profiler is stopped.
+    class HookTimer
+    {
+    public:
+        HookTimer(ElunaProfiler* profiler, const char* group, uint32 event, uint32 entry, int funcRef);
+        ~HookTimer();
+
+    private:
+        ElunaProfiler* prof;
+        HookKey key;
+        HookKey const* prevHook;
+        Clock::time_point start;
+    };
+
+    ElunaProfiler(lua_State* _L);
+    ~ElunaProfiler();
+
+    // Starts hook timing. sampleInterval is the amount of VM instructions between stack samples, 0 disables sampling
+    void Start(uint32 sampleInterval);
+    void Stop();
+    void Reset();
+    bool IsEnabled() const { return enabled; }
+    uint32 GetSampleInterval() const { return sampleInterval; }
+    uint64 GetSampleCount() const { return sampleCount; }
+    HookStatsMap const& GetHookStats() const { return hookStats; }
+
+    // Returns "name (file:line)" of the function stored in the registry under funcRef
+    std::string DescribeRef(int funcRef) const;
+
+    // Writes sampled stacks to path and per hook wall time in microseconds to path.hooks, both in folded-stack format
+    bool DumpFolded(std::string const& path) const;
+
+    // Handles the `.eluna profile` command. Returns false if args is not a profiler subcommand
+    static bool HandleCommand(Player* player, std::string const& args);
+
+private:
+    static void SampleHook(lua_State* L, lua_Debug* ar);
+    static std::string FormatHook(HookKey const& key);
+    void RecordSample(lua_State* L);
+
+    lua_State* L;
+    bool enabled;
+    uint32 sampleInterval;
+    uint64 sampleCount;
+    HookKey const* currentHook;
+    HookStatsMap hookStats;
+    StackSampleMap stackSamples;
+};
+
+#endif
@@ -107,6 +107,138 @@ namespace LuaGlobalFunctions
         return 1;
     }
 
+    // Resolves the array of guids at narg to [Player]s in world, NULL for the ones not found.
+    // The player store is locked once for the whole list instead of once per guid.
+    static void ResolvePlayerGUIDs(lua_State* L, int narg, std::vector<Player*>& players)
+    {
+        luaL_checktype(L, narg, LUA_TTABLE);
+        std::vector<ObjectGuid> guids;
+        int count = lua_rawlen(L, narg);
+        guids.reserve(count);
+        for (int i = 1; i <= count; ++i)
+        {
+            lua_rawgeti(L, narg, i);
+            const char* str = lua_tostring(L, -1);
+            uint64 guid = 0;
+            if (!str || sscanf(str, UI64FMTD, &guid) != 1)
+                luaL_argerror(L, narg, "table of uint64 guids expected");
+            lua_pop(L, 1);
+            guids.push_back(ObjectGuid(guid));
+        }
+
+        players.resize(guids.size(), NULL);
+#ifdef TRINITY
+        boost::shared_lock<boost::shared_mutex> lock(*HashMapHolder<Player>::GetLock());
+        HashMapHolder<Player>::MapType const& m = eObjectAccessor->GetPlayers();
+        for (size_t i = 0; i < guids.size(); ++i)
+        {
+            HashMapHolder<Player>::MapType::const_iterator itr = m.find(guids[i]);
+            if (itr != m.end() && itr->second->IsInWorld())
+                players[i] = itr->second;
+        }
+#else
+        for (size_t i = 0; i < guids.size(); ++i)
+            players[i] = eObjectAccessor->FindPlayer(guids[i]);
+#endif
+    }
+
+    /**
+     * Finds and Returns the [Player]s for a table of guids
+     *
+     * The returned table has the [Player] at the same index as its guid, players that are not found are left nil.
+     *
+     * @param table guids : table of uint64 guids of [Player]s
+     * @return table players
+     */
+    int GetPlayersByGUID(lua_State* L)
+    {
+        std::vector<Player*> players;
+        ResolvePlayerGUIDs(L, 1, players);
+
+        lua_createtable(L, players.size(), 0);
+        int tbl = lua_gettop(L);
+        for (size_t i = 0; i < players.size(); ++i)
+        {
+            if (!players[i])
+                continue;
+            Eluna::Push(L, players[i]);
+            lua_rawseti(L, tbl, i + 1);
+        }
+        return 1;
+    }
+
+    /**
+     * Sends the [WorldPacket] to every [Player] in world in the table of guids
+     *
+     * The packet is built once by the caller and the same packet is sent to every session.
+     *
+     * @param [WorldPacket] packet : packet to send
+     * @param table guids : table of uint64 guids of [Player]s
+     * @return uint32 count : amount of [Player]s the packet was sent to
+     */
+    int SendPacketToGUIDs(lua_State* L)
+    {
+        WorldPacket* data = Eluna::CHECKOBJ<WorldPacket>(L, 1);
+        std::vector<Player*> players;
+        ResolvePlayerGUIDs(L, 2, players);
+
+        uint32 count = 0;
+        for (std::vector<Player*>::const_iterator it = players.begin(); it != players.end(); ++it)
+        {
+            if (!*it)
+                continue;
+            (*it)->GetSession()->SendPacket(data);
+            ++count;
+        }
+        Eluna::Push(L, count);
+        return 1;
+    }
+
+    /**
+     * Sends a broadcast message to every [Player] in world in the table of guids
+     *
+     * The chat packets are built once and shared by all receivers.
+     *
+     * @param string message : message to send
+     * @param table guids : table of uint64 guids of [Player]s
+     * @return uint32 count : amount of [Player]s the message was sent to
+     */
+    int SendBroadcastToGUIDs(lua_State* L)
+    {
+        std::string message = Eluna::CHECKVAL<std::string>(L, 1);
+        std::vector<Player*> players;
+        ResolvePlayerGUIDs(L, 2, players);
+        if (message.empty())
+        {
+            Eluna::Push(L, 0);
+            return 1;
+        }
+
+        // one system message packet per line like ChatHandler::SendSysMessage
+        std::list<WorldPacket> packets;
+        std::istringstream lines(message);
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            if (line.empty())
+                continue;
+            packets.push_back(WorldPacket());
+            ChatHandler::BuildChatPacket(packets.back(), CHAT_MSG_SYSTEM, LANG_UNIVERSAL, NULL, NULL, line);
+        }
+
+        uint32 count = 0;
+        for (std::vector<Player*>::const_iterator it = players.begin(); it != players.end(); ++it)
+        {
+            if (!*it)
+                continue;
+            for (std::list<WorldPacket>::iterator packet = packets.begin(); packet != packets.end(); ++packet)
+                (*it)->GetSession()->SendPacket(&*packet);
+            ++count;
+        }
+        Eluna::Push(L, count);
+        return 1;
+    }
+
     /**
      * Finds and Returns [Player] by name if found
      *
@@ -266,6 +398,27 @@ namespace LuaGlobalFunctions
         return 1;
     }
 
+#ifdef TRINITY
+    /**
+     * Returns the [Spell] allocation counters since startup
+     * Spells not served from the per thread pool and the target container allocations, divided by the spells created, give the allocations per cast
+     *
+     * @return uint64 created
+     * @return uint64 reused : spells that reused a pooled object
+     * @return uint64 targetAllocations : growth of the target containers, the reserve for area spells included
+     */
+    int GetSpellAllocationStats(lua_State* L)
+    {
+        uint64 created, reused, targetAllocations;
+        Spell::GetAllocationStats(created, reused, targetAllocations);
+
+        Eluna::Push(L, created);
+        Eluna::Push(L, reused);
+        Eluna::Push(L, targetAllocations);
+        return 3;
+    }
+#endif
+
     /**
      * Returns [Guild] by the leader's GUID
      *
@@ -989,6 +1142,219 @@ namespace LuaGlobalFunctions
         return 0;
     }
 
+    /**
+     * Registers a match event
+     *
+     * <pre>
+     * enum MatchEvents
+     * {
+     *     MATCH_EVENT_ON_CREATE                           = 1,    // (event, matchId, name, host)
+     *     MATCH_EVENT_ON_JOIN                             = 2,    // (event, matchId, player) - Also called for the host on create, the match has already started if this join filled it
+     *     MATCH_EVENT_ON_LEAVE                            = 3,    // (event, matchId, player) - Called on logout too, player can be nil
+     *     MATCH_EVENT_ON_START                            = 4,    // (event, matchId, phaseMask) - Players are phased and teleported to their spawn points
+     *     MATCH_EVENT_ON_COUNTDOWN_END                    = 5,    // (event, matchId) - Spawn point markers are removed
+     *     MATCH_EVENT_ON_DISBAND                          = 6,    // (event, matchId, reason) - Players are still in the match, reason 0 ended, 1 host lost, 2 empty, 3 shutdown/reload
+     *     MATCH_EVENT_COUNT
+     * };
+     * </pre>
+     *
+     * @param uint32 event : match event Id, refer to MatchEvents above
+     * @param function function : function to register
+     */
+    int RegisterMatchEvent(lua_State* L)
+    {
+        uint32 ev = Eluna::CHECKVAL<uint32>(L, 1);
+        luaL_checktype(L, 2, LUA_TFUNCTION);
+        lua_pushvalue(L, 2);
+        int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        if (functionRef > 0)
+            sEluna->Register(HookMgr::REGTYPE_MATCH, 0, ev, functionRef);
+        return 0;
+    }
+
+    /**
+     * Creates a match queued in the lobby with the [Player] as host
+     *
+     * @param string name : unique name of the match
+     * @param [Player] host
+     * @return uint32 matchId : nil if the name is taken, the host is already in a match, all match phases are in use or no spawn points are configured
+     */
+    int CreateMatch(lua_State* L)
+    {
+        std::string name = Eluna::CHECKVAL<std::string>(L, 1);
+        Player* host = Eluna::CHECKOBJ<Player>(L, 2);
+
+        uint32 matchId = sEluna->matchMgr->CreateMatch(name, host);
+        if (matchId)
+            Eluna::Push(L, matchId);
+        else
+            Eluna::Push(L);
+        return 1;
+    }
+
+    /**
+     * Adds the [Player] to a queued match. The match starts as soon as it has enough players
+     *
+     * @param string name : name of the match
+     * @param [Player] player
+     * @return bool joined : false if the match does not exist, already started or the [Player] is in a match
+     */
+    int JoinMatch(lua_State* L)
+    {
+        std::string name = Eluna::CHECKVAL<std::string>(L, 1);
+        Player* player = Eluna::CHECKOBJ<Player>(L, 2);
+
+        Eluna::Push(L, sEluna->matchMgr->JoinMatch(sEluna->matchMgr->GetMatchId(name), player));
+        return 1;
+    }
+
+    /**
+     * Removes the [Player] from the match it is in
+     *
+     * @param [Player] player
+     * @return bool left : false if the [Player] is not in a match
+     */
+    int LeaveMatch(lua_State* L)
+    {
+        Player* player = Eluna::CHECKOBJ<Player>(L, 1);
+
+        Eluna::Push(L, sEluna->matchMgr->LeaveMatch(player));
+        return 1;
+    }
+
+    /**
+     * Ends and removes the match, its players are returned to the normal phase
+     *
+     * @param uint32 matchId
+     */
+    int EndMatch(lua_State* L)
+    {
+        uint32 matchId = Eluna::CHECKVAL<uint32>(L, 1);
+
+        sEluna->matchMgr->EndMatch(matchId);
+        return 0;
+    }
+
+    /**
+     * Returns the id of the match with the given name
+     *
+     * @param string name : name of the match
+     * @return uint32 matchId : nil if not found
+     */
+    int GetMatchByName(lua_State* L)
+    {
+        std::string name = Eluna::CHECKVAL<std::string>(L, 1);
+
+        uint32 matchId = sEluna->matchMgr->GetMatchId(name);
+        if (matchId)
+            Eluna::Push(L, matchId);
+        else
+            Eluna::Push(L);
+        return 1;
+    }
+
+    /**
+     * Returns the id of the match the [Player] is in
+     *
+     * @param [Player] player
+     * @return uint32 matchId : nil if the [Player] is not in a match
+     */
+    int GetPlayerMatch(lua_State* L)
+    {
+        Player* player = Eluna::CHECKOBJ<Player>(L, 1);
+
+        uint32 matchId = sEluna->matchMgr->GetPlayerMatchId(player->GET_GUID());
+        if (matchId)
+            Eluna::Push(L, matchId);
+        else
+            Eluna::Push(L);
+        return 1;
+    }
+
+    /**
+     * Returns the name, host guid, state and phase mask of the match
+     *
+     * <pre>
+     * enum MatchState
+     * {
+     *     MATCH_STATE_QUEUED      = 1,    // waiting for players in the lobby
+     *     MATCH_STATE_PREPARING   = 2,    // players are teleported to the arena, markers not spawned yet
+     *     MATCH_STATE_COUNTDOWN   = 3,    // players wait on their spawn point markers
+     *     MATCH_STATE_ACTIVE      = 4
+     * };
+     * </pre>
+     *
+     * @param uint32 matchId
+     * @return string name : nil if the match does not exist
+     * @return uint64 host
+     * @return uint32 state
+     * @return uint32 phaseMask : reserved when the match is created
+     */
+    int GetMatchInfo(lua_State* L)
+    {
+        uint32 matchId = Eluna::CHECKVAL<uint32>(L, 1);
+
+        MatchMgr::Match const* match = sEluna->matchMgr->GetMatch(matchId);
+        if (!match)
+            return 0;
+
+        Eluna::Push(L, match->name);
+        Eluna::Push(L, match->host);
+        Eluna::Push(L, uint32(match->state));
+        Eluna::Push(L, match->phaseMask);
+        return 4;
+    }
+
+    /**
+     * Returns a table with the guids of the players in the match in join order
+     *
+     * The table can be passed to [GetPlayersByGUID], [SendPacketToGUIDs] and [SendBroadcastToGUIDs].
+     *
+     * @param uint32 matchId
+     * @return table guids : nil if the match does not exist
+     */
+    int GetMatchPlayers(lua_State* L)
+    {
+        uint32 matchId = Eluna::CHECKVAL<uint32>(L, 1);
+
+        MatchMgr::Match const* match = sEluna->matchMgr->GetMatch(matchId);
+        if (!match)
+            return 0;
+
+        lua_createtable(L, match->players.size(), 0);
+        int tbl = lua_gettop(L);
+        for (size_t i = 0; i < match->players.size(); ++i)
+        {
+            Eluna::Push(L, match->players[i]);
+            lua_rawseti(L, tbl, i + 1);
+        }
+        return 1;
+    }
+
+    /**
+     * Returns a table with the ids of all matches in creation order
+     *
+     * @return table matchIds
+     */
+    int GetMatches(lua_State* L)
+    {
+        MatchMgr::MatchMap const& matches = sEluna->matchMgr->GetMatches();
+        std::vector<uint32> ids;
+        ids.reserve(matches.size());
+        for (MatchMgr::MatchMap::const_iterator it = matches.begin(); it != matches.end(); ++it)
+            ids.push_back(it->first);
+        std::sort(ids.begin(), ids.end());
+
+        lua_createtable(L, ids.size(), 0);
+        int tbl = lua_gettop(L);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            Eluna::Push(L, ids[i]);
+            lua_rawseti(L, tbl, i + 1);
+        }
+        return 1;
+    }
+
     /**
      * Reloads the Lua Engine
      *
@@ -1145,7 +1511,7 @@ namespace LuaGlobalFunctions
         int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
         if (functionRef != LUA_REFNIL && functionRef != LUA_NOREF)
         {
-            sEluna->eventMgr->globalProcessor->AddEvent(functionRef, delay, repeats);
+            sEluna->eventMgr->globalProcessor->AddEvent(functionRef, delay, repeats, sEluna->loadingScript ? sEluna->loadingScript->loadId : 0);
             Eluna::Push(L, functionRef);
         }
         return 1;
@@ -8,6 +8,8 @@
 #include "LuaEngine.h"
 #include "ElunaBinding.h"
 #include "ElunaEventMgr.h"
+#include "ElunaProfiler.h"
+#include "MatchMgr.h"
 #include "ElunaIncludes.h"
 #include "ElunaTemplate.h"
 
@@ -50,31 +52,43 @@ using namespace HookMgr;
     const char* _LuaBindType = sEluna->BINDMAP->groupName; \
     uint32 _LuaEvent = EVENT; \
     int _LuaStackTop = lua_gettop(L); \
-    for (size_t i = 0; i < sEluna->BINDMAP->Bindings[_LuaEvent].size(); ++i) \
-        lua_rawgeti(L, LUA_REGISTRYINDEX, (sEluna->BINDMAP->Bindings[_LuaEvent][i])); \
+    /* the store itself stays in place, the function lists in it move when binds are added */ \
+    std::vector<std::vector<int> > const& _LuaBindings = sEluna->BINDMAP->Bindings; \
+    uint32 const& _LuaGeneration = sEluna->BINDMAP->generation; \
+    int _LuaFuncCount = _LuaBindings[_LuaEvent].size(); \
+    if (!lua_checkstack(L, _LuaFuncCount + 1)) \
+    { \
+        ELUNA_LOG_ERROR("[Eluna]: Executing event %u for %s, no stack space for %i functions", _LuaEvent, _LuaBindType, _LuaFuncCount); \
+        RET; \
+    } \
+    /* the functions go on the stack once, a bound function may register or remove binds while the event runs */ \
+    uint32 _LuaBindGeneration = _LuaGeneration; \
+    for (int i = 0; i < _LuaFuncCount; ++i) \
+        lua_rawgeti(L, LUA_REGISTRYINDEX, _LuaBindings[_LuaEvent][i]); \
     int _LuaFuncTop = lua_gettop(L); \
-    int _LuaFuncCount = _LuaFuncTop-_LuaStackTop; \
     Eluna::Push(L, _LuaEvent);
 
 // use LUA_MULTRET for multiple return values
 // return values will be at top of stack if any
+// The functions and arguments are pushed once and copied for each call, results stack up above them
+// The profiler gets the function ref only while the bindings of the event did not change
 #define EVENT_EXECUTE(RETVALS) \
     int _LuaReturnValues = RETVALS; \
     int _LuaParams = lua_gettop(L) - _LuaFuncTop; \
+    int _LuaRetStart = _LuaFuncTop + _LuaParams + 1; \
     if (_LuaParams < 1) \
     { \
         ELUNA_LOG_ERROR("[Eluna]: Executing event %u for %s, params was %i. Report to devs", _LuaEvent, _LuaBindType, _LuaParams); \
     } \
-    for (int j = _LuaFuncTop-_LuaStackTop; j > 0; --j) \
+    for (int j = _LuaFuncCount - 1; j >= 0; --j) \
     { \
-        for (int i = 0; i <= _LuaParams; ++i) \
-            lua_pushvalue(L, _LuaFuncTop+i); \
+        lua_pushvalue(L, _LuaStackTop + 1 + j); \
+        for (int i = 1; i <= _LuaParams; ++i) \
+            lua_pushvalue(L, _LuaFuncTop + i); \
+        int _LuaRef = _LuaBindGeneration == _LuaGeneration ? _LuaBindings[_LuaEvent][j] : LUA_NOREF; \
+        ElunaProfiler::HookTimer _LuaTimer(sEluna->profiler, _LuaBindType, _LuaEvent, 0, _LuaRef); \
         Eluna::ExecuteCall(L, _LuaParams, _LuaReturnValues); \
-        lua_remove(L, _LuaFuncTop--); \
-    } \
-    for (int i = _LuaParams; i > 0; --i) \
-        if (!lua_isnone(L, i)) \
-            lua_remove(L, i);
+    }
 
 // RET is a return statement
 #define ENTRY_BEGIN(BINDMAP, ENTRY, EVENT, RET) \
@@ -83,29 +97,33 @@ using namespace HookMgr;
         RET; \
     lua_State* L = sEluna->L; \
     const char* _LuaBindType = sEluna->BINDMAP->groupName; \
+    uint32 _LuaEntry = ENTRY; \
     uint32 _LuaEvent = EVENT; \
     int _LuaStackTop = lua_gettop(L); \
     lua_rawgeti(L, LUA_REGISTRYINDEX, _Luabind); \
-    int _LuaFuncTop = lua_gettop(L); \
-    int _LuaFuncCount = _LuaFuncTop-_LuaStackTop; \
+    int _LuaFuncCount = 1; \
     Eluna::Push(L, _LuaEvent);
 
 #define ENTRY_EXECUTE(RETVALS) \
     int _LuaReturnValues = RETVALS; \
     int _LuaParams = lua_gettop(L) - _LuaStackTop - 1; \
-    Eluna::ExecuteCall(L, _LuaParams, _LuaReturnValues);
+    int _LuaRetStart = _LuaStackTop + 1; \
+    { \
+        ElunaProfiler::HookTimer _LuaTimer(sEluna->profiler, _LuaBindType, _LuaEvent, _LuaEntry, _Luabind); \
+        Eluna::ExecuteCall(L, _LuaParams, _LuaReturnValues); \
+    }
 
 #define FOR_RETS(IT) \
-    for (int IT = _LuaStackTop + 1; IT <= lua_gettop(L); ++IT)
+    for (int IT = _LuaRetStart; IT <= lua_gettop(L); ++IT)
 
 #define ENDCALL() \
-    if (lua_gettop(L) < _LuaStackTop) \
+    if (lua_gettop(L) < _LuaRetStart - 1) \
     { \
-        ELUNA_LOG_ERROR("[Eluna]: Ending event %u for %s, stack top was %i and was supposed to be >= %i. Report to devs", _LuaEvent, _LuaBindType, lua_gettop(L), _LuaStackTop); \
+        ELUNA_LOG_ERROR("[Eluna]: Ending event %u for %s, stack top was %i and was supposed to be >= %i. Report to devs", _LuaEvent, _LuaBindType, lua_gettop(L), _LuaRetStart - 1); \
     } \
-    if (_LuaReturnValues != LUA_MULTRET && lua_gettop(L) > _LuaStackTop + _LuaFuncCount * _LuaReturnValues) \
+    if (_LuaReturnValues != LUA_MULTRET && lua_gettop(L) > _LuaRetStart - 1 + _LuaFuncCount * _LuaReturnValues) \
     { \
-        ELUNA_LOG_ERROR("[Eluna]: Ending event %u for %s, stack top was %i and was supposed to be between %i and %i. Report to devs", _LuaEvent, _LuaBindType, lua_gettop(L), _LuaStackTop, _LuaStackTop + _LuaFuncCount * _LuaReturnValues); \
+        ELUNA_LOG_ERROR("[Eluna]: Ending event %u for %s, stack top was %i and was supposed to be between %i and %i. Report to devs", _LuaEvent, _LuaBindType, lua_gettop(L), _LuaRetStart - 1, _LuaRetStart - 1 + _LuaFuncCount * _LuaReturnValues); \
     } \
     lua_settop(L, _LuaStackTop);
 
@@ -349,6 +367,11 @@ void Eluna::OnWorldUpdate(uint32 diff)
         return;
     }
 
+    if (reloadChanged)
+        ReloadChangedScripts();
+
+    matchMgr->Update(diff);
+
     EVENT_BEGIN(ServerEventBindings, WORLD_EVENT_ON_UPDATE, return);
     Push(L, diff);
     EVENT_EXECUTE(0);
@@ -550,12 +573,25 @@ bool Eluna::OnCommand(Player* player, const char* text)
             if (reload == "reload")
             {
                 std::transform(eluna.begin(), eluna.end(), eluna.begin(), ::tolower);
+                // .reload eluna reruns changed files, .reload eluna all restarts the whole lua state
+                std::string mode;
+                std::size_t space = eluna.find(' ');
+                if (space != std::string::npos)
+                {
+                    mode = eluna.substr(space + 1);
+                    eluna = eluna.substr(0, space);
+                }
                 if (std::string("eluna").find(eluna) == 0)
                 {
-                    Eluna::reload = true;
+                    if (mode == "all")
+                        Eluna::reload = true;
+                    else
+                        Eluna::reloadChanged = true;
                     return false;
                 }
             }
+            else if (reload == "eluna" && ElunaProfiler::HandleCommand(player, eluna))
+                return false;
         }
     }
 
@@ -834,6 +870,8 @@ void Eluna::OnLogin(Player* pPlayer)
 
 void Eluna::OnLogout(Player* pPlayer)
 {
+    matchMgr->OnPlayerLogout(pPlayer);
+
     EVENT_BEGIN(PlayerEventBindings, PLAYER_EVENT_ON_LOGOUT, return);
     Push(L, pPlayer);
     EVENT_EXECUTE(0);
@@ -1955,3 +1993,57 @@ void Eluna::OnBGDestroy(BattleGround* bg, BattleGroundTypeId bgId, uint32 instan
     EVENT_EXECUTE(0);
     ENDCALL();
 }
+
+void Eluna::OnMatchCreate(uint32 matchId, std::string const& name, Player* host)
+{
+    EVENT_BEGIN(MatchEventBindings, MATCH_EVENT_ON_CREATE, return);
+    Push(L, matchId);
+    Push(L, name);
+    Push(L, host);
+    EVENT_EXECUTE(0);
+    ENDCALL();
+}
+
+void Eluna::OnMatchJoin(uint32 matchId, Player* player)
+{
+    EVENT_BEGIN(MatchEventBindings, MATCH_EVENT_ON_JOIN, return);
+    Push(L, matchId);
+    Push(L, player);
+    EVENT_EXECUTE(0);
+    ENDCALL();
+}
+
+void Eluna::OnMatchLeave(uint32 matchId, Player* player)
+{
+    EVENT_BEGIN(MatchEventBindings, MATCH_EVENT_ON_LEAVE, return);
+    Push(L, matchId);
+    Push(L, player);
+    EVENT_EXECUTE(0);
+    ENDCALL();
+}
+
+void Eluna::OnMatchStart(uint32 matchId, uint32 phaseMask)
+{
+    EVENT_BEGIN(MatchEventBindings, MATCH_EVENT_ON_START, return);
+    Push(L, matchId);
+    Push(L, phaseMask);
+    EVENT_EXECUTE(0);
+    ENDCALL();
+}
+
+void Eluna::OnMatchCountdownEnd(uint32 matchId)
+{
+    EVENT_BEGIN(MatchEventBindings, MATCH_EVENT_ON_COUNTDOWN_END, return);
+    Push(L, matchId);
+    EVENT_EXECUTE(0);
+    ENDCALL();
+}
+
+void Eluna::OnMatchDisband(uint32 matchId, uint32 reason)
+{
+    EVENT_BEGIN(MatchEventBindings, MATCH_EVENT_ON_DISBAND, return);
+    Push(L, matchId);
+    Push(L, reason);
+    EVENT_EXECUTE(0);
+    ENDCALL();
+}
@@ -25,6 +25,7 @@ namespace HookMgr
         REGTYPE_ITEM_GOSSIP,
         REGTYPE_PLAYER_GOSSIP,
         REGTYPE_BG,
+        REGTYPE_MATCH,
         REGTYPE_COUNT
     };
 
@@ -284,5 +285,17 @@ namespace HookMgr
         BG_EVENT_ON_PRE_DESTROY                         = 4,    // (event, bg, bgId, instanceId) - Needs to be added to TC
         BG_EVENT_COUNT
     };
+
+    // RegisterMatchEvent(EventId, function)
+    enum MatchEvents
+    {
+        MATCH_EVENT_ON_CREATE                           = 1,    // (event, matchId, name, host)
+        MATCH_EVENT_ON_JOIN                             = 2,    // (event, matchId, player) - Also called for the host on create, the match has already started if this join filled it
+        MATCH_EVENT_ON_LEAVE                            = 3,    // (event, matchId, player) - Called on logout too, player can be nil
+        MATCH_EVENT_ON_START                            = 4,    // (event, matchId, phaseMask) - Players are phased and teleported to their spawn points
+        MATCH_EVENT_ON_COUNTDOWN_END                    = 5,    // (event, matchId) - Spawn point markers are removed
+        MATCH_EVENT_ON_DISBAND                          = 6,    // (event, matchId, reason) - Players are still in the match, reason 0 ended, 1 host lost, 2 empty, 3 shutdown/reload
+        MATCH_EVENT_COUNT
+    };
 };
 #endif
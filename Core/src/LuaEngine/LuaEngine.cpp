@@ -8,6 +8,8 @@
 #include "LuaEngine.h"
 #include "ElunaBinding.h"
 #include "ElunaEventMgr.h"
+#include "ElunaProfiler.h"
+#include "MatchMgr.h"
 #include "ElunaIncludes.h"
 #include "ElunaTemplate.h"
 #include "ElunaUtility.h"
@@ -31,6 +33,7 @@ Eluna::ScriptList Eluna::lua_extensions;
 std::string Eluna::lua_folderpath;
 Eluna* Eluna::GEluna = NULL;
 bool Eluna::reload = false;
+bool Eluna::reloadChanged = false;
 
 extern void RegisterFunctions(lua_State* L);
 
@@ -65,6 +68,24 @@ void Eluna::Uninitialize()
     lua_extensions.clear();
 }
 
+#ifdef TRINITY
+// Re initializes the AI of creatures in world with the given entries, all creatures if entries is NULL
+static void ReinitializeCreatureAI(std::set<uint32> const* entries)
+{
+    std::vector<Creature*> creatures;
+    {
+        boost::shared_lock<boost::shared_mutex> lock(*HashMapHolder<Creature>::GetLock());
+        HashMapHolder<Creature>::MapType const& m = ObjectAccessor::GetCreatures();
+        for (HashMapHolder<Creature>::MapType::const_iterator iter = m.begin(); iter != m.end(); ++iter)
+            if (iter->second->IsInWorld() && (!entries || entries->find(iter->second->GetEntry()) != entries->end()))
+                creatures.push_back(iter->second);
+    }
+
+    for (std::vector<Creature*>::const_iterator itr = creatures.begin(); itr != creatures.end(); ++itr)
+        (*itr)->AIM_Initialize();
+}
+#endif
+
 void Eluna::ReloadEluna()
 {
     eWorld->SendServerMessage(SERVER_MSG_STRING, "Reloading Eluna...");
@@ -76,21 +97,21 @@ void Eluna::ReloadEluna()
 
 #ifdef TRINITY
     // Re initialize creature AI restoring C++ AI or applying lua AI
-    {
-        HashMapHolder<Creature>::MapType const m = ObjectAccessor::GetCreatures();
-        for (HashMapHolder<Creature>::MapType::const_iterator iter = m.begin(); iter != m.end(); ++iter)
-            if (iter->second->IsInWorld())
-                iter->second->AIM_Initialize();
-    }
+    ReinitializeCreatureAI(NULL);
 #endif
 
     reload = false;
+    reloadChanged = false;
 }
 
 Eluna::Eluna() :
 L(luaL_newstate()),
 
 eventMgr(NULL),
+profiler(NULL),
+matchMgr(NULL),
+loadingScript(NULL),
+lastLoadId(0),
 
 ServerEventBindings(new EventBind<HookMgr::ServerEvents>("ServerEvents", *this)),
 PlayerEventBindings(new EventBind<HookMgr::PlayerEvents>("PlayerEvents", *this)),
@@ -98,6 +119,7 @@ GuildEventBindings(new EventBind<HookMgr::GuildEvents>("GuildEvents", *this)),
 GroupEventBindings(new EventBind<HookMgr::GroupEvents>("GroupEvents", *this)),
 VehicleEventBindings(new EventBind<HookMgr::VehicleEvents>("VehicleEvents", *this)),
 BGEventBindings(new EventBind<HookMgr::BGEvents>("BGEvents", *this)),
+MatchEventBindings(new EventBind<HookMgr::MatchEvents>("MatchEvents", *this)),
 
 PacketEventBindings(new EntryBind<HookMgr::PacketEvents>("PacketEvents", *this)),
 CreatureEventBindings(new EntryBind<HookMgr::CreatureEvents>("CreatureEvents", *this)),
@@ -112,6 +134,11 @@ playerGossipBindings(new EntryBind<HookMgr::GossipEvents>("GossipEvents (player)
     luaL_openlibs(L);
     RegisterFunctions(L);
 
+    // script files required by other scripts are run through LoadScript, the original require is kept as upvalue
+    lua_getglobal(L, "require");
+    lua_pushcclosure(L, &Eluna::Require, 1);
+    lua_setglobal(L, "require");
+
     // Create hidden table with weak values
     lua_newtable(L);
     lua_newtable(L);
@@ -120,6 +147,8 @@ playerGossipBindings(new EntryBind<HookMgr::GossipEvents>("GossipEvents (player)
     lua_setmetatable(L, -2);
     userdata_table = luaL_ref(L, LUA_REGISTRYINDEX);
 
+    profiler = new ElunaProfiler(L);
+
     // Replace this with map insert if making multithread version
     ASSERT(!Eluna::GEluna);
     Eluna::GEluna = this;
@@ -127,13 +156,18 @@ playerGossipBindings(new EntryBind<HookMgr::GossipEvents>("GossipEvents (player)
     // Set event manager. Must be after setting sEluna
     eventMgr = new EventMgr();
     eventMgr->globalProcessor = new ElunaEventProcessor(NULL);
+
+    matchMgr = new MatchMgr();
 }
 
 Eluna::~Eluna()
 {
     OnLuaStateClose();
 
+    // Before the event manager, ending the matches calls their disband hooks
+    delete matchMgr;
     delete eventMgr;
+    delete profiler;
 
     // Replace this with map remove if making multithread version
     Eluna::GEluna = NULL;
@@ -153,6 +187,7 @@ Eluna::~Eluna()
     delete ItemGossipBindings;
     delete playerGossipBindings;
     delete BGEventBindings;
+    delete MatchEventBindings;
 
     // Must close lua state after deleting stores and mgr
     lua_close(L);
@@ -180,6 +215,15 @@ void Eluna::AddScriptPath(std::string filename, std::string fullpath, ScriptList
     script.filename = filename;
     script.filepath = fullpath;
     script.modulepath = fullpath.substr(0, fullpath.length() - ext.length());
+#ifdef USING_BOOST
+    boost::system::error_code ec;
+    script.modified = boost::filesystem::last_write_time(fullpath, ec);
+    if (ec)
+        script.modified = 0;
+#else
+    ACE_stat stat_buf;
+    script.modified = ACE_OS::stat(fullpath.c_str(), &stat_buf) == -1 ? 0 : stat_buf.st_mtime;
+#endif
     if (extension)
         lua_extensions.push_back(script);
     else
@@ -263,16 +307,94 @@ static bool ScriptpathComparator(const LuaScript& first, const LuaScript& second
     return first.filepath.compare(second.filepath) < 0;
 }
 
+// Extensions first, then scripts, both in path order
+static void GetSortedScripts(Eluna::ScriptList& scripts)
+{
+    Eluna::lua_extensions.sort(ScriptpathComparator);
+    Eluna::lua_scripts.sort(ScriptpathComparator);
+    scripts.insert(scripts.end(), Eluna::lua_extensions.begin(), Eluna::lua_extensions.end());
+    scripts.insert(scripts.end(), Eluna::lua_scripts.begin(), Eluna::lua_scripts.end());
+}
+
+// Runs the file and stores its result to package.loaded, recording the binds it registers as owned by the file
+bool Eluna::LoadScript(LuaScript const& script, int modules)
+{
+    ScriptState& state = scriptStates[script.filepath];
+    state.modified = script.modified;
+    state.loadId = ++lastLoadId;
+
+    // a required file runs while the file that requires it is loading
+    ScriptState* requiredBy = loadingScript;
+    loadingScript = &state;
+    bool loaded = !luaL_loadfile(L, script.filepath.c_str()) && !lua_pcall(L, 0, 1, 0);
+    loadingScript = requiredBy;
+
+    if (!loaded)
+    {
+        ELUNA_LOG_ERROR("[Eluna]: Error loading extension `%s`", script.filepath.c_str());
+        report(L);
+        return false;
+    }
+
+    if (!lua_toboolean(L, -1))
+    {
+        lua_pop(L, 1);
+        Push(L, true);
+    }
+    lua_setfield(L, modules, script.modulepath.c_str());
+
+    // successfully loaded and ran file
+    ELUNA_LOG_DEBUG("[Eluna]: Successfully loaded `%s`", script.filepath.c_str());
+    return true;
+}
+
+static LuaScript const* FindScript(Eluna::ScriptList const& scripts, const char* modulepath)
+{
+    for (Eluna::ScriptList::const_iterator it = scripts.begin(); it != scripts.end(); ++it)
+        if (it->modulepath == modulepath)
+            return &*it;
+    return NULL;
+}
+
+// require for the module path of a script file, the file is loaded on its own so it owns the binds it registers
+int Eluna::Require(lua_State* L)
+{
+    const char* name = luaL_checkstring(L, 1);
+
+    lua_getglobal(L, "package");
+    luaL_getsubtable(L, -1, "loaded");
+    int modules = lua_gettop(L);
+    lua_getfield(L, modules, name);
+    if (!lua_isnoneornil(L, -1))
+        return 1;
+    lua_pop(L, 1);
+
+    LuaScript const* script = FindScript(lua_extensions, name);
+    if (!script)
+        script = FindScript(lua_scripts, name);
+    if (script)
+    {
+        if (!sEluna->LoadScript(*script, modules))
+            return luaL_error(L, "error loading module '%s' from file '%s'", name, script->filepath.c_str());
+
+        lua_getfield(L, modules, name);
+        return 1;
+    }
+
+    // not one of our script files
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_pushvalue(L, 1);
+    lua_call(L, 1, 1);
+    return 1;
+}
+
 void Eluna::RunScripts()
 {
     uint32 oldMSTime = ElunaUtil::GetCurrTime();
     uint32 count = 0;
 
     ScriptList scripts;
-    lua_extensions.sort(ScriptpathComparator);
-    lua_scripts.sort(ScriptpathComparator);
-    scripts.insert(scripts.end(), lua_extensions.begin(), lua_extensions.end());
-    scripts.insert(scripts.end(), lua_scripts.begin(), lua_scripts.end());
+    GetSortedScripts(scripts);
 
     lua_getglobal(L, "package");
     luaL_getsubtable(L, -1, "loaded");
@@ -283,32 +405,142 @@ void Eluna::RunScripts()
         if (!lua_isnoneornil(L, -1))
         {
             lua_pop(L, 1);
+            // required by an earlier file, Require ran it through LoadScript
             ELUNA_LOG_DEBUG("[Eluna]: Extension was already loaded or required `%s`", it->filepath.c_str());
             continue;
         }
         lua_pop(L, 1);
-        if (!luaL_loadfile(L, it->filepath.c_str()) && !lua_pcall(L, 0, 1, 0))
+        if (LoadScript(*it, modules))
+            ++count;
+    }
+    lua_pop(L, 2);
+
+    ELUNA_LOG_INFO("[Eluna]: Executed %u Lua scripts in %u ms", count, ElunaUtil::GetTimeDiff(oldMSTime));
+
+    OnLuaStateOpen();
+}
+
+// Puts back a bind of the previous version of a file, run through lua_pcall
+static int InsertBindProtected(lua_State* L)
+{
+    sEluna->InsertBind(*static_cast<Eluna::ScriptBind const*>(lua_touserdata(L, 1)));
+    return 0;
+}
+
+static void CollectCreatureEntries(Eluna::ScriptBindList const& binds, std::set<uint32>& entries)
+{
+    for (Eluna::ScriptBindList::const_iterator it = binds.begin(); it != binds.end(); ++it)
+        if (it->regtype == HookMgr::REGTYPE_CREATURE)
+            entries.insert(it->id);
+}
+
+void Eluna::ReloadChangedScripts()
+{
+    uint32 oldMSTime = ElunaUtil::GetCurrTime();
+    uint32 count = 0;
+
+    lua_scripts.clear();
+    lua_extensions.clear();
+    GetScripts(lua_folderpath, lua_scripts);
+
+    ScriptList scripts;
+    GetSortedScripts(scripts);
+
+    std::set<std::string> found;
+    std::set<uint32> changedEntries;
+
+    lua_getglobal(L, "package");
+    luaL_getsubtable(L, -1, "loaded");
+    int modules = lua_gettop(L);
+    for (ScriptList::const_iterator it = scripts.begin(); it != scripts.end(); ++it)
+    {
+        found.insert(it->filepath);
+        ScriptStateMap::iterator state = scriptStates.find(it->filepath);
+        if (state != scriptStates.end() && state->second.modified == it->modified)
+            continue;
+
+        // Take the old binds out of the stores, they are put back if the new version fails to load
+        ScriptBindList oldBinds;
+        uint32 oldLoadId = 0;
+        if (state != scriptStates.end())
         {
-            if (!lua_toboolean(L, -1))
+            oldBinds.swap(state->second.binds);
+            oldLoadId = state->second.loadId;
+        }
+        for (ScriptBindList::const_iterator bind = oldBinds.begin(); bind != oldBinds.end(); ++bind)
+            RemoveBind(*bind);
+
+        lua_pushnil(L);
+        lua_setfield(L, modules, it->modulepath.c_str());
+        if (LoadScript(*it, modules))
+        {
+            for (ScriptBindList::const_iterator bind = oldBinds.begin(); bind != oldBinds.end(); ++bind)
+                luaL_unref(L, LUA_REGISTRYINDEX, bind->funcRef);
+            if (oldLoadId)
+                eventMgr->RemoveOwnedEvents(oldLoadId);
+
+            CollectCreatureEntries(oldBinds, changedEntries);
+            CollectCreatureEntries(scriptStates[it->filepath].binds, changedEntries);
+            ELUNA_LOG_INFO("[Eluna]: Reloaded `%s`", it->filepath.c_str());
+            ++count;
+            continue;
+        }
+
+        // Drop whatever the failed load registered and restore the previous version
+        ScriptState& current = scriptStates[it->filepath];
+        for (ScriptBindList::const_iterator bind = current.binds.begin(); bind != current.binds.end(); ++bind)
+        {
+            RemoveBind(*bind);
+            luaL_unref(L, LUA_REGISTRYINDEX, bind->funcRef);
+        }
+        eventMgr->RemoveOwnedEvents(current.loadId);
+        current.binds.swap(oldBinds);
+        current.loadId = oldLoadId;
+        for (ScriptBindList::iterator bind = current.binds.begin(); bind != current.binds.end();)
+        {
+            // another file may have taken an entry meanwhile, the store raises a lua error and frees the ref then
+            lua_pushcfunction(L, &InsertBindProtected);
+            lua_pushlightuserdata(L, &*bind);
+            if (lua_pcall(L, 1, 0, 0))
             {
-                lua_pop(L, 1);
-                Push(L, true);
+                report(L);
+                bind = current.binds.erase(bind);
             }
-            lua_setfield(L, modules, it->modulepath.c_str());
+            else
+                ++bind;
+        }
+        ELUNA_LOG_ERROR("[Eluna]: Kept the previously loaded version of `%s`", it->filepath.c_str());
+    }
 
-            // successfully loaded and ran file
-            ELUNA_LOG_DEBUG("[Eluna]: Successfully loaded `%s`", it->filepath.c_str());
-            ++count;
+    // Unload the files that were deleted
+    for (ScriptStateMap::iterator state = scriptStates.begin(); state != scriptStates.end();)
+    {
+        if (found.find(state->first) != found.end())
+        {
+            ++state;
             continue;
         }
-        ELUNA_LOG_ERROR("[Eluna]: Error loading extension `%s`", it->filepath.c_str());
-        report(L);
+
+        for (ScriptBindList::const_iterator bind = state->second.binds.begin(); bind != state->second.binds.end(); ++bind)
+        {
+            RemoveBind(*bind);
+            luaL_unref(L, LUA_REGISTRYINDEX, bind->funcRef);
+        }
+        eventMgr->RemoveOwnedEvents(state->second.loadId);
+        CollectCreatureEntries(state->second.binds, changedEntries);
+        ELUNA_LOG_INFO("[Eluna]: Unloaded removed script `%s`", state->first.c_str());
+        scriptStates.erase(state++);
     }
     lua_pop(L, 2);
 
-    ELUNA_LOG_INFO("[Eluna]: Executed %u Lua scripts in %u ms", count, ElunaUtil::GetTimeDiff(oldMSTime));
+#ifdef TRINITY
+    // Only creatures whose lua bindings changed need their AI swapped
+    if (!changedEntries.empty())
+        ReinitializeCreatureAI(&changedEntries);
+#endif
 
-    OnLuaStateOpen();
+    ELUNA_LOG_INFO("[Eluna]: Reloaded %u changed Lua scripts in %u ms", count, ElunaUtil::GetTimeDiff(oldMSTime));
+    reloadChanged = false;
 }
 
 void Eluna::RemoveRef(const void* obj)
@@ -625,54 +857,35 @@ template<> Corpse* Eluna::CHECKOBJ<Corpse>(lua_State* L, int narg, bool error)
 // Saves the function reference ID given to the register type's store for given entry under the given event
 void Eluna::Register(uint8 regtype, uint32 id, uint32 evt, int functionRef)
 {
+    bool valid = false;
     switch (regtype)
     {
         case HookMgr::REGTYPE_SERVER:
-            if (evt < HookMgr::SERVER_EVENT_COUNT)
-            {
-                ServerEventBindings->Insert(evt, functionRef);
-                return;
-            }
+            valid = evt < HookMgr::SERVER_EVENT_COUNT;
             break;
 
         case HookMgr::REGTYPE_PLAYER:
-            if (evt < HookMgr::PLAYER_EVENT_COUNT)
-            {
-                PlayerEventBindings->Insert(evt, functionRef);
-                return;
-            }
+            valid = evt < HookMgr::PLAYER_EVENT_COUNT;
             break;
 
         case HookMgr::REGTYPE_GUILD:
-            if (evt < HookMgr::GUILD_EVENT_COUNT)
-            {
-                GuildEventBindings->Insert(evt, functionRef);
-                return;
-            }
+            valid = evt < HookMgr::GUILD_EVENT_COUNT;
             break;
 
         case HookMgr::REGTYPE_GROUP:
-            if (evt < HookMgr::GROUP_EVENT_COUNT)
-            {
-                GroupEventBindings->Insert(evt, functionRef);
-                return;
-            }
+            valid = evt < HookMgr::GROUP_EVENT_COUNT;
             break;
 
         case HookMgr::REGTYPE_VEHICLE:
-            if (evt < HookMgr::VEHICLE_EVENT_COUNT)
-            {
-                VehicleEventBindings->Insert(evt, functionRef);
-                return;
-            }
+            valid = evt < HookMgr::VEHICLE_EVENT_COUNT;
             break;
 
         case HookMgr::REGTYPE_BG:
-            if (evt < HookMgr::BG_EVENT_COUNT)
-            {
-                BGEventBindings->Insert(evt, functionRef);
-                return;
-            }
+            valid = evt < HookMgr::BG_EVENT_COUNT;
+            break;
+
+        case HookMgr::REGTYPE_MATCH:
+            valid = evt < HookMgr::MATCH_EVENT_COUNT;
             break;
 
         case HookMgr::REGTYPE_PACKET:
@@ -684,9 +897,7 @@ void Eluna::Register(uint8 regtype, uint32 id, uint32 evt, int functionRef)
                     luaL_error(L, "Couldn't find a creature with (ID: %d)!", id);
                     return;
                 }
-
-                PacketEventBindings->Insert(id, evt, functionRef);
-                return;
+                valid = true;
             }
             break;
 
@@ -699,9 +910,7 @@ void Eluna::Register(uint8 regtype, uint32 id, uint32 evt, int functionRef)
                     luaL_error(L, "Couldn't find a creature with (ID: %d)!", id);
                     return;
                 }
-
-                CreatureEventBindings->Insert(id, evt, functionRef);
-                return;
+                valid = true;
             }
             break;
 
@@ -714,9 +923,7 @@ void Eluna::Register(uint8 regtype, uint32 id, uint32 evt, int functionRef)
                     luaL_error(L, "Couldn't find a creature with (ID: %d)!", id);
                     return;
                 }
-
-                CreatureGossipBindings->Insert(id, evt, functionRef);
-                return;
+                valid = true;
             }
             break;
 
@@ -729,9 +936,7 @@ void Eluna::Register(uint8 regtype, uint32 id, uint32 evt, int functionRef)
                     luaL_error(L, "Couldn't find a gameobject with (ID: %d)!", id);
                     return;
                 }
-
-                GameObjectEventBindings->Insert(id, evt, functionRef);
-                return;
+                valid = true;
             }
             break;
 
@@ -744,9 +949,7 @@ void Eluna::Register(uint8 regtype, uint32 id, uint32 evt, int functionRef)
                     luaL_error(L, "Couldn't find a gameobject with (ID: %d)!", id);
                     return;
                 }
-
-                GameObjectGossipBindings->Insert(id, evt, functionRef);
-                return;
+                valid = true;
             }
             break;
 
@@ -759,9 +962,7 @@ void Eluna::Register(uint8 regtype, uint32 id, uint32 evt, int functionRef)
                     luaL_error(L, "Couldn't find a item with (ID: %d)!", id);
                     return;
                 }
-
-                ItemEventBindings->Insert(id, evt, functionRef);
-                return;
+                valid = true;
             }
             break;
 
@@ -774,20 +975,72 @@ void Eluna::Register(uint8 regtype, uint32 id, uint32 evt, int functionRef)
                     luaL_error(L, "Couldn't find a item with (ID: %d)!", id);
                     return;
                 }
-
-                ItemGossipBindings->Insert(id, evt, functionRef);
-                return;
+                valid = true;
             }
             break;
 
         case HookMgr::REGTYPE_PLAYER_GOSSIP:
-            if (evt < HookMgr::GOSSIP_EVENT_COUNT)
-            {
-                playerGossipBindings->Insert(id, evt, functionRef);
-                return;
-            }
+            valid = evt < HookMgr::GOSSIP_EVENT_COUNT;
             break;
     }
-    luaL_unref(L, LUA_REGISTRYINDEX, functionRef);
-    luaL_error(L, "Unknown event type (regtype %d, id %d, event %d)", regtype, id, evt);
+
+    if (!valid)
+    {
+        luaL_unref(L, LUA_REGISTRYINDEX, functionRef);
+        luaL_error(L, "Unknown event type (regtype %d, id %d, event %d)", regtype, id, evt);
+        return;
+    }
+
+    ScriptBind bind = { regtype, id, evt, functionRef };
+    InsertBind(bind);
+
+    // the bind belongs to the file being run, a reload of that file takes it out again
+    if (loadingScript)
+        loadingScript->binds.push_back(bind);
+}
+
+// Puts a previously registered function back to its store, the arguments were validated on registration
+void Eluna::InsertBind(ScriptBind const& bind)
+{
+    switch (bind.regtype)
+    {
+        case HookMgr::REGTYPE_SERVER: ServerEventBindings->Insert(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_PLAYER: PlayerEventBindings->Insert(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_GUILD: GuildEventBindings->Insert(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_GROUP: GroupEventBindings->Insert(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_VEHICLE: VehicleEventBindings->Insert(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_BG: BGEventBindings->Insert(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_MATCH: MatchEventBindings->Insert(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_PACKET: PacketEventBindings->Insert(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_CREATURE: CreatureEventBindings->Insert(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_CREATURE_GOSSIP: CreatureGossipBindings->Insert(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_GAMEOBJECT: GameObjectEventBindings->Insert(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_GAMEOBJECT_GOSSIP: GameObjectGossipBindings->Insert(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_ITEM: ItemEventBindings->Insert(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_ITEM_GOSSIP: ItemGossipBindings->Insert(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_PLAYER_GOSSIP: playerGossipBindings->Insert(bind.id, bind.evt, bind.funcRef); break;
+    }
+}
+
+// Takes a registered function out of its store, the function ref is not freed
+void Eluna::RemoveBind(ScriptBind const& bind)
+{
+    switch (bind.regtype)
+    {
+        case HookMgr::REGTYPE_SERVER: ServerEventBindings->Remove(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_PLAYER: PlayerEventBindings->Remove(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_GUILD: GuildEventBindings->Remove(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_GROUP: GroupEventBindings->Remove(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_VEHICLE: VehicleEventBindings->Remove(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_BG: BGEventBindings->Remove(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_MATCH: MatchEventBindings->Remove(bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_PACKET: PacketEventBindings->Remove(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_CREATURE: CreatureEventBindings->Remove(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_CREATURE_GOSSIP: CreatureGossipBindings->Remove(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_GAMEOBJECT: GameObjectEventBindings->Remove(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_GAMEOBJECT_GOSSIP: GameObjectGossipBindings->Remove(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_ITEM: ItemEventBindings->Remove(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_ITEM_GOSSIP: ItemGossipBindings->Remove(bind.id, bind.evt, bind.funcRef); break;
+        case HookMgr::REGTYPE_PLAYER_GOSSIP: playerGossipBindings->Remove(bind.id, bind.evt, bind.funcRef); break;
+    }
 }
@@ -82,6 +82,8 @@ typedef VehicleInfo Vehicle;
 
 struct lua_State;
 class EventMgr;
+class ElunaProfiler;
+class MatchMgr;
 template<typename T>
 class ElunaTemplate;
 template<typename T>
@@ -95,6 +97,7 @@ struct LuaScript
     std::string filename;
     std::string filepath;
     std::string modulepath;
+    time_t modified;
 };
 
 class Eluna
@@ -107,13 +110,41 @@ private:
 public:
     typedef std::list<LuaScript> ScriptList;
 
+    // A function registered while a script file was executed
+    struct ScriptBind
+    {
+        uint8 regtype;
+        uint32 id;
+        uint32 evt;
+        int funcRef;
+    };
+    typedef std::vector<ScriptBind> ScriptBindList;
+
+    // Everything a loaded script file owns, used to reload the file on its own
+    struct ScriptState
+    {
+        ScriptState() : loadId(0), modified(0) { }
+
+        uint32 loadId;      // owner tag of the timed events created while the file ran
+        time_t modified;
+        ScriptBindList binds;
+    };
+    typedef std::map<std::string, ScriptState> ScriptStateMap;
+
     static Eluna* GEluna;
     static bool reload;
+    static bool reloadChanged;
 
     lua_State* L;
     int userdata_table;
 
     EventMgr* eventMgr;
+    ElunaProfiler* profiler;
+    MatchMgr* matchMgr;
+
+    ScriptStateMap scriptStates;    // keyed by file path
+    ScriptState* loadingScript;     // file being executed, NULL outside script loading
+    uint32 lastLoadId;
 
     EventBind<HookMgr::ServerEvents>*       ServerEventBindings;
     EventBind<HookMgr::PlayerEvents>*       PlayerEventBindings;
@@ -121,6 +152,7 @@ public:
     EventBind<HookMgr::GroupEvents>*        GroupEventBindings;
     EventBind<HookMgr::VehicleEvents>*      VehicleEventBindings;
     EventBind<HookMgr::BGEvents>*           BGEventBindings;
+    EventBind<HookMgr::MatchEvents>*        MatchEventBindings;
 
     EntryBind<HookMgr::PacketEvents>*       PacketEventBindings;
     EntryBind<HookMgr::CreatureEvents>*     CreatureEventBindings;
@@ -142,13 +174,20 @@ public:
     // Use Eluna::reload = true; instead.
     // This will be called on next update
     static void ReloadEluna();
+    // Use Eluna::reloadChanged = true; instead.
+    // Reruns only the script files that changed on disk since they were loaded, keeping the lua state
+    void ReloadChangedScripts();
     static void GetScripts(std::string path, ScriptList& scripts);
     static void AddScriptPath(std::string filename, std::string fullpath, ScriptList& scripts);
 
     static void report(lua_State*);
     static void ExecuteCall(lua_State* L, int params, int res);
     void Register(uint8 reg, uint32 id, uint32 evt, int func);
+    void InsertBind(ScriptBind const& bind);
+    void RemoveBind(ScriptBind const& bind);
     void RunScripts();
+    bool LoadScript(LuaScript const& script, int modules);
+    static int Require(lua_State* L);
     static void RemoveRef(const void* obj);
 
     // Pushes
@@ -354,6 +393,14 @@ public:
     void OnBGEnd(BattleGround* bg, BattleGroundTypeId bgId, uint32 instanceId, Team winner);
     void OnBGCreate(BattleGround* bg, BattleGroundTypeId bgId, uint32 instanceId);
     void OnBGDestroy(BattleGround* bg, BattleGroundTypeId bgId, uint32 instanceId);
+
+    /* Match */
+    void OnMatchCreate(uint32 matchId, std::string const& name, Player* host);
+    void OnMatchJoin(uint32 matchId, Player* player);
+    void OnMatchLeave(uint32 matchId, Player* player);
+    void OnMatchStart(uint32 matchId, uint32 phaseMask);
+    void OnMatchCountdownEnd(uint32 matchId);
+    void OnMatchDisband(uint32 matchId, uint32 reason);
 };
 template<> Unit* Eluna::CHECKOBJ<Unit>(lua_State* L, int narg, bool error);
 template<> Player* Eluna::CHECKOBJ<Player>(lua_State* L, int narg, bool error);
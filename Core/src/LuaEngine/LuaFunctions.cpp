@@ -12,6 +12,7 @@ extern "C"
 // Eluna
 #include "LuaEngine.h"
 #include "ElunaEventMgr.h"
+#include "MatchMgr.h"
 #include "ElunaIncludes.h"
 #include "ElunaTemplate.h"
 #include "ElunaUtility.h"
@@ -54,6 +55,7 @@ void RegisterGlobals(lua_State* L)
     lua_register(L, "RegisterItemGossipEvent", &LuaGlobalFunctions::RegisterItemGossipEvent);               // RegisterItemGossipEvent(entry, event, function)
     lua_register(L, "RegisterPlayerGossipEvent", &LuaGlobalFunctions::RegisterPlayerGossipEvent);           // RegisterPlayerGossipEvent(menu_id, event, function)
     lua_register(L, "RegisterBGEvent", &LuaGlobalFunctions::RegisterBGEvent);                               // RegisterBGEvent(event, function)
+    lua_register(L, "RegisterMatchEvent", &LuaGlobalFunctions::RegisterMatchEvent);                         // RegisterMatchEvent(event, function)
 
     // Getters
     lua_register(L, "GetLuaEngine", &LuaGlobalFunctions::GetLuaEngine);
@@ -62,6 +64,7 @@ void RegisterGlobals(lua_State* L)
     lua_register(L, "GetCoreExpansion", &LuaGlobalFunctions::GetCoreExpansion);
     lua_register(L, "GetQuest", &LuaGlobalFunctions::GetQuest);
     lua_register(L, "GetPlayerByGUID", &LuaGlobalFunctions::GetPlayerByGUID);
+    lua_register(L, "GetPlayersByGUID", &LuaGlobalFunctions::GetPlayersByGUID);
     lua_register(L, "GetPlayerByName", &LuaGlobalFunctions::GetPlayerByName);
     lua_register(L, "GetGameTime", &LuaGlobalFunctions::GetGameTime);
     lua_register(L, "GetPlayersInWorld", &LuaGlobalFunctions::GetPlayersInWorld);
@@ -85,11 +88,21 @@ void RegisterGlobals(lua_State* L)
     lua_register(L, "bit_and", &LuaGlobalFunctions::bit_and);
     lua_register(L, "GetItemLink", &LuaGlobalFunctions::GetItemLink);
     lua_register(L, "GetMapById", &LuaGlobalFunctions::GetMapById);
+#ifdef TRINITY
+    lua_register(L, "GetSpellAllocationStats", &LuaGlobalFunctions::GetSpellAllocationStats);  // GetSpellAllocationStats() - Returns spells created, spells that reused a pooled object and target container allocations
+#endif
 	lua_register(L, "GetHungerGamesInitialTime", &LuaGlobalFunctions::GetHungerGamesInitialTime);
+    lua_register(L, "GetMatchByName", &LuaGlobalFunctions::GetMatchByName);
+    lua_register(L, "GetPlayerMatch", &LuaGlobalFunctions::GetPlayerMatch);
+    lua_register(L, "GetMatchInfo", &LuaGlobalFunctions::GetMatchInfo);
+    lua_register(L, "GetMatchPlayers", &LuaGlobalFunctions::GetMatchPlayers);
+    lua_register(L, "GetMatches", &LuaGlobalFunctions::GetMatches);
 
     // Other
     lua_register(L, "ReloadEluna", &LuaGlobalFunctions::ReloadEluna);
     lua_register(L, "SendWorldMessage", &LuaGlobalFunctions::SendWorldMessage);
+    lua_register(L, "SendPacketToGUIDs", &LuaGlobalFunctions::SendPacketToGUIDs);
+    lua_register(L, "SendBroadcastToGUIDs", &LuaGlobalFunctions::SendBroadcastToGUIDs);
     lua_register(L, "WorldDBQuery", &LuaGlobalFunctions::WorldDBQuery);
     lua_register(L, "WorldDBExecute", &LuaGlobalFunctions::WorldDBExecute);
     lua_register(L, "CharDBQuery", &LuaGlobalFunctions::CharDBQuery);
@@ -100,6 +113,10 @@ void RegisterGlobals(lua_State* L)
     lua_register(L, "RemoveEventById", &LuaGlobalFunctions::RemoveEventById);
     lua_register(L, "RemoveEvents", &LuaGlobalFunctions::RemoveEvents);
     lua_register(L, "PerformIngameSpawn", &LuaGlobalFunctions::PerformIngameSpawn);
+    lua_register(L, "CreateMatch", &LuaGlobalFunctions::CreateMatch);
+    lua_register(L, "JoinMatch", &LuaGlobalFunctions::JoinMatch);
+    lua_register(L, "LeaveMatch", &LuaGlobalFunctions::LeaveMatch);
+    lua_register(L, "EndMatch", &LuaGlobalFunctions::EndMatch);
     lua_register(L, "CreatePacket", &LuaGlobalFunctions::CreatePacket);
     lua_register(L, "AddVendorItem", &LuaGlobalFunctions::AddVendorItem);
     lua_register(L, "VendorRemoveItem", &LuaGlobalFunctions::VendorRemoveItem);
@@ -1155,6 +1172,9 @@ ElunaRegister<Map> MapMethods[] =
     { "GetAreaId", &LuaMap::GetAreaId },                      // :GetAreaId(x, y, z) - Returns the map's area ID based on coords UNDOCUMENTED
     { "GetHeight", &LuaMap::GetHeight },                      // :GetHeight(x, y[, phasemask]) - Returns ground Z coordinate. UNDOCUMENTED
     { "GetWorldObject", &LuaMap::GetWorldObject },            // :GetWorldObject(guid) - Returns a worldobject (player, creature, gameobject..) from the map by it's guid
+#ifdef TRINITY
+    { "GetLineOfSightCacheStats", &LuaMap::GetLineOfSightCacheStats }, // :GetLineOfSightCacheStats() - Returns hits, misses, trace time of the misses in us and cached entries
+#endif
 
     // Booleans
 #ifndef CLASSIC
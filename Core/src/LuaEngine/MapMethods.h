@@ -188,6 +188,27 @@ namespace LuaMap
         return 1;
     }
 
+#ifdef TRINITY
+    /**
+     * Returns the counters of the line of sight cache of the [Map]
+     * The trace time is the total time spent on the queries that missed the cache
+     *
+     * @return uint64 hits
+     * @return uint64 misses
+     * @return uint64 traceTimeUs
+     * @return uint32 entries
+     */
+    int GetLineOfSightCacheStats(lua_State* L, Map* map)
+    {
+        LineOfSightCache const& cache = map->GetLineOfSightCache();
+        Eluna::Push(L, cache.GetHits());
+        Eluna::Push(L, cache.GetMisses());
+        Eluna::Push(L, cache.GetTraceTimeUs());
+        Eluna::Push(L, cache.GetSize());
+        return 4;
+    }
+#endif
+
     /**
      * Returns a [WorldObject] by it's guid from the map if it is spawned
      *
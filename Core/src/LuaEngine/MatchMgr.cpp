@@ -0,0 +1,428 @@
+/*
+* Copyright (C) 2010 - 2014 Eluna Lua Engine <http://emudevs.com/>
+* This program is free software licensed under GPL version 3
+* Please see the included DOCS/LICENSE.md for more information
+*/
+
+#include "MatchMgr.h"
+#include "LuaEngine.h"
+#include "ElunaIncludes.h"
+
+#include <algorithm>
+#include <sstream>
+
+#define MATCH_ARENA_MAP         800
+#define MATCH_MARKER_ENTRY      184719
+#define MATCH_MARKER_SCALE      0.05f
+#define MATCH_MARKER_DELAY      1000    // ms after the teleport before the markers spawn
+#define MATCH_COUNTDOWN         29000   // ms the markers stay up
+#define MATCH_MIN_PLAYERS       3
+#define MATCH_SPAWN_POINTS      "-4088.836 3880.989 6.6 3.952591, -4105.4 3897.5744 6.6 3.913325, -4121.458 3914.43 6.6 3.960447"
+
+// Phase bit of idle pooled markers, never given to a match or player
+#define MATCH_PHASE_IDLE        0x80000000
+#define MATCH_PHASE_FIRST_BIT   1
+#define MATCH_PHASE_LAST_BIT    30
+
+MatchMgr::MatchMgr() : lastMatchId(0), now(0), usedPhases(0), minPlayers(MATCH_MIN_PLAYERS)
+{
+    minPlayers = std::max(1, eConfigMgr->GetIntDefault("Eluna.Match.MinPlayers", MATCH_MIN_PLAYERS));
+    LoadSpawnPoints(eConfigMgr->GetStringDefault("Eluna.Match.SpawnPoints", MATCH_SPAWN_POINTS));
+    markers.resize(arenaSpawnPoints.size());
+}
+
+MatchMgr::~MatchMgr()
+{
+    // The lua state is closing on reload or shutdown, end the matches while the hooks can still reset their players
+    std::vector<uint32> matchIds;
+    for (MatchMap::const_iterator it = matches.begin(); it != matches.end(); ++it)
+        matchIds.push_back(it->first);
+    for (std::vector<uint32>::const_iterator it = matchIds.begin(); it != matchIds.end(); ++it)
+        if (Match* match = FindMatch(*it))
+            Disband(match, MATCH_DISBAND_SHUTDOWN);
+
+    if (Map* map = eMapMgr->FindMap(MATCH_ARENA_MAP, 0))
+    {
+        for (std::vector<MarkerSlot>::const_iterator it = markers.begin(); it != markers.end(); ++it)
+            if (it->guid)
+                if (GameObject* marker = map->GetGameObject(ObjectGuid(it->guid)))
+                    marker->Delete();
+    }
+}
+
+// Spawn points are "x y z o" separated by commas
+void MatchMgr::LoadSpawnPoints(std::string const& points)
+{
+    std::istringstream list(points);
+    std::string point;
+    while (std::getline(list, point, ','))
+    {
+        if (point.find_first_not_of(" \t") == std::string::npos)
+            continue;
+
+        SpawnPoint spawn;
+        std::istringstream coords(point);
+        if (!(coords >> spawn.x >> spawn.y >> spawn.z >> spawn.o))
+        {
+            ELUNA_LOG_ERROR("[Eluna]: Eluna.Match.SpawnPoints has an invalid spawn point `%s`, skipped", point.c_str());
+            continue;
+        }
+
+        // spawn points and their markers are indexed by uint8
+        if (arenaSpawnPoints.size() == UINT8_MAX)
+        {
+            ELUNA_LOG_ERROR("[Eluna]: Eluna.Match.SpawnPoints has more than %u spawn points, the rest is ignored", uint32(UINT8_MAX));
+            break;
+        }
+        arenaSpawnPoints.push_back(spawn);
+    }
+
+    if (arenaSpawnPoints.empty())
+    {
+        ELUNA_LOG_ERROR("[Eluna]: Eluna.Match.SpawnPoints has no spawn point, matches can not be created");
+        return;
+    }
+
+    ELUNA_LOG_INFO("[Eluna]: Loaded %u match spawn points", uint32(arenaSpawnPoints.size()));
+}
+
+void MatchMgr::Update(uint32 diff)
+{
+    now += diff;
+    while (!timers.empty() && timers.begin()->first <= now)
+    {
+        uint64 due = timers.begin()->first;
+        uint32 matchId = timers.begin()->second;
+        timers.erase(timers.begin());
+
+        // entries of disbanded matches and rescheduled timers are skipped
+        Match* match = FindMatch(matchId);
+        if (!match || match->timer != due)
+            continue;
+
+        match->timer = 0;
+        OnTimer(match);
+    }
+}
+
+uint32 MatchMgr::CreateMatch(std::string const& name, Player* host)
+{
+    uint64 hostGuid = host->GET_GUID();
+    if (name.empty() || matchNames.find(name) != matchNames.end() || playerMatches.find(hostGuid) != playerMatches.end())
+        return 0;
+
+    if (arenaSpawnPoints.empty())
+    {
+        ELUNA_LOG_ERROR("[Eluna]: Match `%s` not created, Eluna.Match.SpawnPoints has no spawn point", name.c_str());
+        return 0;
+    }
+
+    // every match owns its phase bit from the start, running out of them refuses the match here instead of stalling a full one
+    uint32 phaseMask = AllocatePhase();
+    if (!phaseMask)
+    {
+        ELUNA_LOG_ERROR("[Eluna]: Match `%s` not created, all %u match phases are in use", name.c_str(), uint32(MATCH_PHASE_LAST_BIT - MATCH_PHASE_FIRST_BIT + 1));
+        return 0;
+    }
+
+    Match* match = new Match();
+    match->id = ++lastMatchId;
+    match->name = name;
+    match->host = hostGuid;
+    match->state = MATCH_STATE_QUEUED;
+    match->phaseMask = phaseMask;
+    match->timer = 0;
+    match->disbanding = false;
+
+    uint32 matchId = match->id;
+    matches[matchId] = match;
+    matchNames[name] = matchId;
+    match->players.push_back(hostGuid);
+    playerMatches[hostGuid] = matchId;
+
+    sEluna->OnMatchCreate(matchId, name, host);
+    StartIfFull(matchId);
+    if (FindMatch(matchId))
+        sEluna->OnMatchJoin(matchId, host);
+    return matchId;
+}
+
+bool MatchMgr::JoinMatch(uint32 matchId, Player* player)
+{
+    Match* match = FindMatch(matchId);
+    uint64 guid = player->GET_GUID();
+    if (!match || match->state != MATCH_STATE_QUEUED || match->disbanding || playerMatches.find(guid) != playerMatches.end())
+        return false;
+
+    match->players.push_back(guid);
+    playerMatches[guid] = matchId;
+
+    // a join that fills the match starts it before the join hook, which then no longer sends the player to the lobby
+    StartIfFull(matchId);
+    if (FindMatch(matchId))
+        sEluna->OnMatchJoin(matchId, player);
+    return true;
+}
+
+bool MatchMgr::LeaveMatch(Player* player)
+{
+    uint64 guid = player->GET_GUID();
+    Match* match = FindMatch(GetPlayerMatchId(guid));
+    if (!match)
+        return false;
+
+    RemovePlayer(match, guid, false);
+    return true;
+}
+
+void MatchMgr::EndMatch(uint32 matchId)
+{
+    if (Match* match = FindMatch(matchId))
+        Disband(match, MATCH_DISBAND_ENDED);
+}
+
+void MatchMgr::OnPlayerLogout(Player* player)
+{
+    uint64 guid = player->GET_GUID();
+    if (Match* match = FindMatch(GetPlayerMatchId(guid)))
+        RemovePlayer(match, guid, true);
+}
+
+MatchMgr::Match const* MatchMgr::GetMatch(uint32 matchId) const
+{
+    MatchMap::const_iterator it = matches.find(matchId);
+    return it != matches.end() ? it->second : NULL;
+}
+
+uint32 MatchMgr::GetMatchId(std::string const& name) const
+{
+    MatchNameMap::const_iterator it = matchNames.find(name);
+    return it != matchNames.end() ? it->second : 0;
+}
+
+uint32 MatchMgr::GetPlayerMatchId(uint64 guid) const
+{
+    PlayerMatchMap::const_iterator it = playerMatches.find(guid);
+    return it != playerMatches.end() ? it->second : 0;
+}
+
+MatchMgr::Match* MatchMgr::FindMatch(uint32 matchId)
+{
+    MatchMap::const_iterator it = matches.find(matchId);
+    return it != matches.end() ? it->second : NULL;
+}
+
+void MatchMgr::RemovePlayer(Match* match, uint64 guid, bool logout)
+{
+    GuidList::iterator it = std::find(match->players.begin(), match->players.end(), guid);
+    if (it == match->players.end())
+        return;
+
+    if (!match->spawnPoints.empty())
+        match->spawnPoints.erase(match->spawnPoints.begin() + (it - match->players.begin()));
+    match->players.erase(it);
+    playerMatches.erase(guid);
+
+    Player* player = eObjectAccessor->FindPlayer(ObjectGuid(guid));
+    if (player && match->state != MATCH_STATE_QUEUED)
+        player->SetPhaseMask(PHASEMASK_NORMAL, !logout);
+
+    uint32 matchId = match->id;
+    sEluna->OnMatchLeave(matchId, player);
+
+    match = FindMatch(matchId);
+    if (!match)
+        return;
+
+    if (match->state == MATCH_STATE_QUEUED && match->host == guid)
+        Disband(match, MATCH_DISBAND_HOST_LOST);
+    else if (match->players.empty())
+        Disband(match, MATCH_DISBAND_EMPTY);
+}
+
+void MatchMgr::Disband(Match* match, MatchDisbandReason reason)
+{
+    if (match->disbanding)
+        return;
+    match->disbanding = true;
+
+    // players are still listed so the hook can notify them
+    uint32 matchId = match->id;
+    sEluna->OnMatchDisband(matchId, reason);
+
+    if (match->state == MATCH_STATE_COUNTDOWN)
+    {
+        Map* map = eMapMgr->FindMap(MATCH_ARENA_MAP, 0);
+        for (uint8 i = 0; i < markers.size(); ++i)
+            ReleaseMarker(map, i, match->phaseMask);
+    }
+
+    for (GuidList::const_iterator it = match->players.begin(); it != match->players.end(); ++it)
+    {
+        playerMatches.erase(*it);
+        if (match->state == MATCH_STATE_QUEUED)
+            continue;
+
+        if (Player* player = eObjectAccessor->FindPlayer(ObjectGuid(*it)))
+        {
+            player->SetPhaseMask(PHASEMASK_NORMAL, true);
+            // nothing is left to bring them back from the arena once the scripts are gone
+            if (reason == MATCH_DISBAND_SHUTDOWN && player->GetMapId() == MATCH_ARENA_MAP)
+                player->TeleportTo(player->m_homebindMapId, player->m_homebindX, player->m_homebindY, player->m_homebindZ, player->GetOrientation());
+        }
+    }
+
+    matchNames.erase(match->name);
+    matches.erase(matchId);
+    FreePhase(match->phaseMask);
+    delete match;
+}
+
+void MatchMgr::SetTimer(Match* match, uint32 delay)
+{
+    match->timer = now + delay;
+    timers.insert(TimerQueue::value_type(match->timer, match->id));
+}
+
+void MatchMgr::OnTimer(Match* match)
+{
+    Map* map = eMapMgr->FindMap(MATCH_ARENA_MAP, 0);
+    switch (match->state)
+    {
+        case MATCH_STATE_PREPARING:
+            if (map)
+                for (std::vector<uint8>::const_iterator it = match->spawnPoints.begin(); it != match->spawnPoints.end(); ++it)
+                    AcquireMarker(map, *it, match->phaseMask);
+            match->state = MATCH_STATE_COUNTDOWN;
+            SetTimer(match, MATCH_COUNTDOWN);
+            break;
+        case MATCH_STATE_COUNTDOWN:
+            for (uint8 i = 0; i < markers.size(); ++i)
+                ReleaseMarker(map, i, match->phaseMask);
+            match->state = MATCH_STATE_ACTIVE;
+            sEluna->OnMatchCountdownEnd(match->id);
+            break;
+        default:
+            break;
+    }
+}
+
+void MatchMgr::StartIfFull(uint32 matchId)
+{
+    Match* match = FindMatch(matchId);
+    if (match && match->state == MATCH_STATE_QUEUED && !match->disbanding && match->players.size() >= minPlayers)
+        Start(match);
+}
+
+void MatchMgr::Start(Match* match)
+{
+    match->state = MATCH_STATE_PREPARING;
+
+    std::vector<uint8> points;
+    for (uint8 i = 0; i < arenaSpawnPoints.size(); ++i)
+        points.push_back(i);
+    std::random_shuffle(points.begin(), points.end());
+
+    match->spawnPoints.clear();
+    MapManager::GroupTeleportList moves;
+    for (size_t i = 0; i < match->players.size(); ++i)
+    {
+        uint8 point = points[i % points.size()];
+        match->spawnPoints.push_back(point);
+
+        Player* player = eObjectAccessor->FindPlayer(ObjectGuid(match->players[i]));
+        if (!player)
+            continue;
+
+        SpawnPoint const& pos = arenaSpawnPoints[point];
+        moves.push_back(std::make_pair(player, Position(pos.x, pos.y, pos.z, pos.o)));
+    }
+
+    std::vector<Player*> failed;
+    eMapMgr->TeleportGroupTo(MATCH_ARENA_MAP, moves, failed);
+
+    // a teleported player leaves the lobby map, the new phase needs no visibility update there.
+    // A player whose teleport was rejected stays in the lobby and gets the update
+    for (MapManager::GroupTeleportList::const_iterator itr = moves.begin(); itr != moves.end(); ++itr)
+    {
+        bool teleported = std::find(failed.begin(), failed.end(), itr->first) == failed.end();
+        itr->first->SetPhaseMask(match->phaseMask, !teleported);
+    }
+
+    SetTimer(match, MATCH_MARKER_DELAY);
+    sEluna->OnMatchStart(match->id, match->phaseMask);
+}
+
+uint32 MatchMgr::AllocatePhase()
+{
+    for (uint32 bit = MATCH_PHASE_FIRST_BIT; bit <= MATCH_PHASE_LAST_BIT; ++bit)
+    {
+        uint32 mask = 1 << bit;
+        if (!(usedPhases & mask))
+        {
+            usedPhases |= mask;
+            return mask;
+        }
+    }
+    return 0;
+}
+
+void MatchMgr::FreePhase(uint32 phaseMask)
+{
+    usedPhases &= ~phaseMask;
+}
+
+void MatchMgr::AcquireMarker(Map* map, uint8 point, uint32 phaseMask)
+{
+    MarkerSlot& slot = markers[point];
+    slot.phaseMask |= phaseMask;
+
+    // reuse the pooled marker if its grid is still loaded
+    if (slot.guid)
+    {
+        if (GameObject* marker = map->GetGameObject(ObjectGuid(slot.guid)))
+        {
+            marker->SetPhaseMask(slot.phaseMask, true);
+            return;
+        }
+        slot.guid = 0;
+    }
+
+    SpawnPoint const& pos = arenaSpawnPoints[point];
+    GameObject* marker = new GameObject;
+    if (!marker->Create(eObjectMgr->GenerateLowGuid(HIGHGUID_GAMEOBJECT), MATCH_MARKER_ENTRY, map, slot.phaseMask, pos.x, pos.y, pos.z, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0, GO_STATE_READY))
+    {
+        delete marker;
+        return;
+    }
+
+    marker->SetObjectScale(MATCH_MARKER_SCALE);
+    marker->SetUInt32Value(GAMEOBJECT_FLAGS, GO_FLAG_IN_USE);
+    if (!map->AddToMap(marker))
+    {
+        delete marker;
+        return;
+    }
+    slot.guid = marker->GET_GUID();
+}
+
+void MatchMgr::ReleaseMarker(Map* map, uint8 point, uint32 phaseMask)
+{
+    MarkerSlot& slot = markers[point];
+    if (!(slot.phaseMask & phaseMask))
+        return;
+
+    slot.phaseMask &= ~phaseMask;
+    if (!slot.guid || !map)
+        return;
+
+    GameObject* marker = map->GetGameObject(ObjectGuid(slot.guid));
+    if (!marker)
+    {
+        slot.guid = 0;
+        return;
+    }
+
+    // idle markers stay in the map out of sight until the next countdown or until their grid unloads
+    marker->SetPhaseMask(slot.phaseMask ? slot.phaseMask : MATCH_PHASE_IDLE, true);
+}
@@ -0,0 +1,125 @@
+/*
+* Copyright (C) 2010 - 2014 Eluna Lua Engine <http://emudevs.com/>
+* This program is free software licensed under GPL version 3
+* Please see the included DOCS/LICENSE.md for more information
+*/
+
+#ifndef _ELUNA_MATCHMGR_H
+#define _ELUNA_MATCHMGR_H
+
+#include "Common.h"
+#include "ElunaUtility.h"
+#include <map>
+
+class Player;
+class Map;
+
+enum MatchState
+{
+    MATCH_STATE_QUEUED      = 1,    // waiting for players in the lobby
+    MATCH_STATE_PREPARING   = 2,    // players are teleported to the arena, markers not spawned yet
+    MATCH_STATE_COUNTDOWN   = 3,    // players wait on their spawn point markers
+    MATCH_STATE_ACTIVE      = 4
+};
+
+enum MatchDisbandReason
+{
+    MATCH_DISBAND_ENDED     = 0,    // EndMatch was called
+    MATCH_DISBAND_HOST_LOST = 1,    // host logged out or left before the match started
+    MATCH_DISBAND_EMPTY     = 2,    // the last player left
+    MATCH_DISBAND_SHUTDOWN  = 3     // the lua state closed on reload or shutdown, arena players are sent home
+};
+
+/*
+ * Owns the Hunger Games match lifecycle: the lobby queue, the start countdown,
+ * spawn point assignment and the cleanup when players log out or the host leaves.
+ *
+ * Matches are indexed by id, name and player guid. State changes are driven by
+ * joins, leaves and per match deadlines kept in a time ordered queue, so an update
+ * only touches the matches that have something due. Game rules stay in Lua and are
+ * notified through RegisterMatchEvent hooks.
+ */
+class MatchMgr
+{
+public:
+    typedef std::vector<uint64> GuidList;
+
+    struct Match
+    {
+        uint32 id;
+        std::string name;
+        uint64 host;
+        GuidList players;       // join order
+        MatchState state;
+        uint32 phaseMask;       // own phase bit, players are moved to it when the match starts
+        uint64 timer;           // due time of the pending state change, 0 if none
+        std::vector<uint8> spawnPoints; // spawn point index per player, in join order
+        bool disbanding;
+    };
+
+    typedef UNORDERED_MAP<uint32, Match*> MatchMap;
+    typedef UNORDERED_MAP<std::string, uint32> MatchNameMap;
+    typedef UNORDERED_MAP<uint64, uint32> PlayerMatchMap;
+    typedef std::multimap<uint64, uint32> TimerQueue;
+
+    MatchMgr();
+    ~MatchMgr();
+
+    void Update(uint32 diff);
+
+    // Returns the new match id or 0 if the name is taken, the host is already in a match or all match phases are in use
+    uint32 CreateMatch(std::string const& name, Player* host);
+    bool JoinMatch(uint32 matchId, Player* player);
+    bool LeaveMatch(Player* player);
+    void EndMatch(uint32 matchId);
+    void OnPlayerLogout(Player* player);
+
+    Match const* GetMatch(uint32 matchId) const;
+    uint32 GetMatchId(std::string const& name) const;
+    uint32 GetPlayerMatchId(uint64 guid) const;
+    MatchMap const& GetMatches() const { return matches; }
+
+private:
+    struct SpawnPoint
+    {
+        float x, y, z, o;
+    };
+
+    // One marker object per spawn point, shared by all matches in countdown through their phase bits
+    struct MarkerSlot
+    {
+        MarkerSlot() : guid(0), phaseMask(0) { }
+
+        uint64 guid;
+        uint32 phaseMask;
+    };
+
+    Match* FindMatch(uint32 matchId);
+    void RemovePlayer(Match* match, uint64 guid, bool logout);
+    void Disband(Match* match, MatchDisbandReason reason);
+    void SetTimer(Match* match, uint32 delay);
+    void OnTimer(Match* match);
+
+    void LoadSpawnPoints(std::string const& points);
+    void StartIfFull(uint32 matchId);
+    void Start(Match* match);
+    uint32 AllocatePhase();
+    void FreePhase(uint32 phaseMask);
+
+    void AcquireMarker(Map* map, uint8 point, uint32 phaseMask);
+    void ReleaseMarker(Map* map, uint8 point, uint32 phaseMask);
+
+    uint32 lastMatchId;
+    uint64 now;             // ms of world update time since creation
+    uint32 usedPhases;
+    uint32 minPlayers;
+
+    MatchMap matches;
+    MatchNameMap matchNames;
+    PlayerMatchMap playerMatches;
+    TimerQueue timers;
+    std::vector<SpawnPoint> arenaSpawnPoints;   // from Eluna.Match.SpawnPoints
+    std::vector<MarkerSlot> markers;            // per spawn point
+};
+
+#endif
@@ -0,0 +1,393 @@
+/*
+ * Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2009 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DYNAMIC_BVH
+#define _DYNAMIC_BVH
+
+#include "Define.h"
+#include "Errors.h"
+
+#include <G3D/AABox.h>
+#include <G3D/BoundsTrait.h>
+#include <G3D/Ray.h>
+#include <G3D/Vector3.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+/*
+  @class DynamicBVH
+  Bounding volume hierarchy over objects that come, go and move while the
+  tree is queried.  Every object is a leaf with a fat box, its bounds grown
+  by FAT_MARGIN.  Insertion walks down to the sibling of least added surface
+  area, removal hands the sibling the parent's place, and the ancestors of
+  both are refit and rotated AVL style so the tree never needs a rebuild.
+  An object that moves within its fat box costs nothing, one that leaves it
+  is reinserted.  Queries do not modify the tree.
+*/
+template<class T, class BoundsFunc = BoundsTrait<T> >
+class DynamicBVH
+{
+    enum
+    {
+        NULL_NODE = -1
+    };
+
+    struct Node
+    {
+        G3D::AABox bounds;
+        const T* object;
+        int32 parent;               // next free node while the node is not used
+        int32 child1;
+        int32 child2;
+        int32 height;               // 0 for leaves, -1 for free nodes
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    typedef std::unordered_map<const T*, int32> LeafMap;
+
+    std::vector<Node> m_nodes;
+    int32 m_root;
+    int32 m_freeList;
+    LeafMap m_leaves;
+
+public:
+    static float const FAT_MARGIN;
+
+    DynamicBVH() : m_root(NULL_NODE), m_freeList(NULL_NODE) { }
+
+    void insert(const T& obj)
+    {
+        ASSERT(!m_leaves.count(&obj));
+        int32 leaf = allocateNode();
+        m_nodes[leaf].object = &obj;
+        m_nodes[leaf].bounds = fatBounds(obj);
+        m_nodes[leaf].height = 0;
+        insertLeaf(leaf);
+        m_leaves[&obj] = leaf;
+    }
+
+    void remove(const T& obj)
+    {
+        typename LeafMap::iterator itr = m_leaves.find(&obj);
+        if (itr == m_leaves.end())
+            return;
+
+        removeLeaf(itr->second);
+        freeNode(itr->second);
+        m_leaves.erase(itr);
+    }
+
+    // Call after the bounds of obj changed
+    void relocate(const T& obj)
+    {
+        typename LeafMap::iterator itr = m_leaves.find(&obj);
+        if (itr == m_leaves.end())
+            return;
+
+        G3D::AABox bounds;
+        BoundsFunc::getBounds2(&obj, bounds);
+        int32 leaf = itr->second;
+        if (m_nodes[leaf].bounds.contains(bounds))
+            return;
+
+        removeLeaf(leaf);
+        m_nodes[leaf].bounds = fatBounds(obj);
+        insertLeaf(leaf);
+    }
+
+    bool contains(const T& obj) const { return m_leaves.count(&obj) != 0; }
+    int size() const { return int(m_leaves.size()); }
+
+    // The callback returns true on a hit and lowers maxDist to it, with stopAtFirst the first hit ends the search
+    template<typename RayCallback>
+    void intersectRay(const G3D::Ray& ray, RayCallback& intersectCallback, float& maxDist, bool stopAtFirst) const
+    {
+        if (m_root == NULL_NODE)
+            return;
+
+        G3D::Vector3 const& org = ray.origin();
+        G3D::Vector3 const& invDir = ray.invDirection();
+
+        int32 stack[64];
+        int32 stackSize = 0;
+        stack[stackSize++] = m_root;
+        while (stackSize)
+        {
+            Node const& node = m_nodes[stack[--stackSize]];
+            if (!intersectBox(node.bounds, org, invDir, maxDist))
+                continue;
+
+            if (node.isLeaf())
+            {
+                if (intersectCallback(ray, *node.object, maxDist) && stopAtFirst)
+                    return;
+                continue;
+            }
+
+            // the tree is AVL balanced, its height stays far below the stack size
+            ASSERT(stackSize + 2 <= 64);
+            stack[stackSize++] = node.child1;
+            stack[stackSize++] = node.child2;
+        }
+    }
+
+private:
+    static G3D::AABox fatBounds(const T& obj)
+    {
+        G3D::AABox bounds;
+        BoundsFunc::getBounds2(&obj, bounds);
+        G3D::Vector3 margin(FAT_MARGIN, FAT_MARGIN, FAT_MARGIN);
+        return G3D::AABox(bounds.low() - margin, bounds.high() + margin);
+    }
+
+    static G3D::AABox merge(G3D::AABox const& a, G3D::AABox const& b)
+    {
+        return G3D::AABox(a.low().min(b.low()), a.high().max(b.high()));
+    }
+
+    static float perimeter(G3D::AABox const& box)
+    {
+        G3D::Vector3 extent = box.high() - box.low();
+        return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+    }
+
+    // slab test of the segment [0, maxDist] of the ray against box
+    static bool intersectBox(G3D::AABox const& box, G3D::Vector3 const& org, G3D::Vector3 const& invDir, float maxDist)
+    {
+        float tMin = 0.0f;
+        float tMax = maxDist;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float t1 = (box.low()[axis] - org[axis]) * invDir[axis];
+            float t2 = (box.high()[axis] - org[axis]) * invDir[axis];
+            if (t1 > t2)
+                std::swap(t1, t2);
+            // NaN from a ray running along a face is ignored by these comparisons
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            if (tMin > tMax)
+                return false;
+        }
+        return true;
+    }
+
+    int32 allocateNode()
+    {
+        int32 index;
+        if (m_freeList != NULL_NODE)
+        {
+            index = m_freeList;
+            m_freeList = m_nodes[index].parent;
+        }
+        else
+        {
+            index = int32(m_nodes.size());
+            m_nodes.push_back(Node());
+        }
+
+        Node& node = m_nodes[index];
+        node.object = NULL;
+        node.parent = NULL_NODE;
+        node.child1 = NULL_NODE;
+        node.child2 = NULL_NODE;
+        node.height = 0;
+        return index;
+    }
+
+    void freeNode(int32 index)
+    {
+        m_nodes[index].parent = m_freeList;
+        m_nodes[index].height = -1;
+        m_freeList = index;
+    }
+
+    void insertLeaf(int32 leaf)
+    {
+        if (m_root == NULL_NODE)
+        {
+            m_root = leaf;
+            m_nodes[leaf].parent = NULL_NODE;
+            return;
+        }
+
+        // find the best sibling by the surface area the insertion adds
+        G3D::AABox leafBounds = m_nodes[leaf].bounds;
+        int32 index = m_root;
+        while (!m_nodes[index].isLeaf())
+        {
+            Node const& node = m_nodes[index];
+            float area = perimeter(node.bounds);
+            float combinedArea = perimeter(merge(node.bounds, leafBounds));
+
+            // cost of making a new parent of this node and the leaf
+            float cost = 2.0f * combinedArea;
+            // minimum cost of pushing the leaf further down
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            float cost1 = childCost(node.child1, leafBounds) + inheritanceCost;
+            float cost2 = childCost(node.child2, leafBounds) + inheritanceCost;
+            if (cost < cost1 && cost < cost2)
+                break;
+
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        int32 sibling = index;
+        int32 oldParent = m_nodes[sibling].parent;
+        int32 newParent = allocateNode();
+        m_nodes[newParent].parent = oldParent;
+        m_nodes[newParent].bounds = merge(leafBounds, m_nodes[sibling].bounds);
+        m_nodes[newParent].height = m_nodes[sibling].height + 1;
+        m_nodes[newParent].child1 = sibling;
+        m_nodes[newParent].child2 = leaf;
+        m_nodes[sibling].parent = newParent;
+        m_nodes[leaf].parent = newParent;
+
+        if (oldParent != NULL_NODE)
+        {
+            if (m_nodes[oldParent].child1 == sibling)
+                m_nodes[oldParent].child1 = newParent;
+            else
+                m_nodes[oldParent].child2 = newParent;
+        }
+        else
+            m_root = newParent;
+
+        refit(m_nodes[leaf].parent);
+    }
+
+    float childCost(int32 child, G3D::AABox const& leafBounds) const
+    {
+        Node const& node = m_nodes[child];
+        float area = perimeter(merge(node.bounds, leafBounds));
+        return node.isLeaf() ? area : area - perimeter(node.bounds);
+    }
+
+    void removeLeaf(int32 leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = NULL_NODE;
+            return;
+        }
+
+        int32 parent = m_nodes[leaf].parent;
+        int32 grandParent = m_nodes[parent].parent;
+        int32 sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+        if (grandParent != NULL_NODE)
+        {
+            if (m_nodes[grandParent].child1 == parent)
+                m_nodes[grandParent].child1 = sibling;
+            else
+                m_nodes[grandParent].child2 = sibling;
+            m_nodes[sibling].parent = grandParent;
+            freeNode(parent);
+            refit(grandParent);
+        }
+        else
+        {
+            m_root = sibling;
+            m_nodes[sibling].parent = NULL_NODE;
+            freeNode(parent);
+        }
+    }
+
+    // walks from index to the root, rebalancing and fixing heights and bounds
+    void refit(int32 index)
+    {
+        while (index != NULL_NODE)
+        {
+            index = rotate(index);
+
+            Node& node = m_nodes[index];
+            node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+            node.bounds = merge(m_nodes[node.child1].bounds, m_nodes[node.child2].bounds);
+            index = node.parent;
+        }
+    }
+
+    // rotates the higher grandchild up if the children of a differ in height by more than one, returns the new subtree root
+    int32 rotate(int32 a)
+    {
+        Node& nodeA = m_nodes[a];
+        if (nodeA.isLeaf() || nodeA.height < 2)
+            return a;
+
+        int32 b = nodeA.child1;
+        int32 c = nodeA.child2;
+        int32 balance = m_nodes[c].height - m_nodes[b].height;
+        if (balance > 1)
+            return rotateUp(a, c, b);
+        if (balance < -1)
+            return rotateUp(a, b, c);
+        return a;
+    }
+
+    // promotes child up over a, other is the remaining child of a
+    int32 rotateUp(int32 a, int32 up, int32 other)
+    {
+        Node& nodeA = m_nodes[a];
+        Node& nodeUp = m_nodes[up];
+        int32 f = nodeUp.child1;
+        int32 g = nodeUp.child2;
+
+        // up takes the place of a
+        nodeUp.child1 = a;
+        nodeUp.parent = nodeA.parent;
+        nodeA.parent = up;
+
+        if (nodeUp.parent != NULL_NODE)
+        {
+            if (m_nodes[nodeUp.parent].child1 == a)
+                m_nodes[nodeUp.parent].child1 = up;
+            else
+                m_nodes[nodeUp.parent].child2 = up;
+        }
+        else
+            m_root = up;
+
+        // the higher of the children of up stays with it, the other goes to a
+        int32 keep = f;
+        int32 give = g;
+        if (m_nodes[f].height < m_nodes[g].height)
+            std::swap(keep, give);
+
+        nodeUp.child2 = keep;
+        if (nodeA.child1 == up)
+            nodeA.child1 = give;
+        else
+            nodeA.child2 = give;
+        m_nodes[give].parent = a;
+
+        nodeA.bounds = merge(m_nodes[other].bounds, m_nodes[give].bounds);
+        nodeA.height = 1 + std::max(m_nodes[other].height, m_nodes[give].height);
+        nodeUp.bounds = merge(nodeA.bounds, m_nodes[keep].bounds);
+        nodeUp.height = 1 + std::max(nodeA.height, m_nodes[keep].height);
+        return up;
+    }
+};
+
+// doors and transports move a little at a time, a yard of slack saves most reinsertions
+template<class T, class BoundsFunc>
+float const DynamicBVH<T, BoundsFunc>::FAT_MARGIN = 1.0f;
+
+#endif // _DYNAMIC_BVH
@@ -17,15 +17,12 @@
  */
 
 #include "DynamicTree.h"
-//#include "QuadTree.h"
-//#include "RegularGrid.h"
-#include "BoundingIntervalHierarchyWrapper.h"
+#include "DynamicBoundingVolumeHierarchy.h"
 
 #include "Log.h"
-#include "RegularGrid.h"
-#include "Timer.h"
 #include "GameObjectModel.h"
 #include "ModelInstance.h"
+#include "IVMapManager.h"
 
 #include <G3D/AABox.h>
 #include <G3D/Ray.h>
@@ -33,20 +30,6 @@
 
 using VMAP::ModelInstance;
 
-namespace {
-
-int CHECK_TREE_PERIOD = 200;
-
-} // namespace
-
-template<> struct HashTrait< GameObjectModel>{
-    static size_t hashCode(const GameObjectModel& g) { return (size_t)(void*)&g; }
-};
-
-template<> struct PositionTrait< GameObjectModel> {
-    static void getPosition(const GameObjectModel& g, G3D::Vector3& p) { p = g.getPosition(); }
-};
-
 template<> struct BoundsTrait< GameObjectModel> {
     static void getBounds(const GameObjectModel& g, G3D::AABox& out) { out = g.getBounds();}
     static void getBounds2(const GameObjectModel* g, G3D::AABox& out) { out = g->getBounds();}
@@ -58,53 +41,8 @@ static bool operator == (const GameObjectModel& mdl, const GameObjectModel& mdl2
 }
 */
 
-typedef RegularGrid2D<GameObjectModel, BIHWrap<GameObjectModel> > ParentTree;
-
-struct DynTreeImpl : public ParentTree/*, public Intersectable*/
+struct DynTreeImpl : public DynamicBVH<GameObjectModel>
 {
-    typedef GameObjectModel Model;
-    typedef ParentTree base;
-
-    DynTreeImpl() :
-        rebalance_timer(CHECK_TREE_PERIOD),
-        unbalanced_times(0)
-    {
-    }
-
-    void insert(const Model& mdl)
-    {
-        base::insert(mdl);
-        ++unbalanced_times;
-    }
-
-    void remove(const Model& mdl)
-    {
-        base::remove(mdl);
-        ++unbalanced_times;
-    }
-
-    void balance()
-    {
-        base::balance();
-        unbalanced_times = 0;
-    }
-
-    void update(uint32 difftime)
-    {
-        if (!size())
-            return;
-
-        rebalance_timer.Update(difftime);
-        if (rebalance_timer.Passed())
-        {
-            rebalance_timer.Reset(CHECK_TREE_PERIOD);
-            if (unbalanced_times > 0)
-                balance();
-        }
-    }
-
-    TimeTrackerSmall rebalance_timer;
-    int unbalanced_times;
 };
 
 DynamicMapTree::DynamicMapTree() : impl(new DynTreeImpl()) { }
@@ -129,9 +67,9 @@ bool DynamicMapTree::contains(const GameObjectModel& mdl) const
     return impl->contains(mdl);
 }
 
-void DynamicMapTree::balance()
+void DynamicMapTree::relocate(const GameObjectModel& mdl)
 {
-    impl->balance();
+    impl->relocate(mdl);
 }
 
 int DynamicMapTree::size() const
@@ -139,11 +77,6 @@ int DynamicMapTree::size() const
     return impl->size();
 }
 
-void DynamicMapTree::update(uint32 t_diff)
-{
-    impl->update(t_diff);
-}
-
 struct DynamicTreeIntersectionCallback
 {
     bool did_hit;
@@ -151,8 +84,10 @@ struct DynamicTreeIntersectionCallback
     DynamicTreeIntersectionCallback(uint32 phasemask) : did_hit(false), phase_mask(phasemask) { }
     bool operator()(const G3D::Ray& r, const GameObjectModel& obj, float& distance)
     {
-        did_hit = obj.intersectRay(r, distance, true, phase_mask);
-        return did_hit;
+        bool hit = obj.intersectRay(r, distance, true, phase_mask);
+        if (hit)
+            did_hit = true;
+        return hit;
     }
     bool didHit() const { return did_hit;}
 };
@@ -184,7 +119,8 @@ bool DynamicMapTree::getIntersectionTime(const uint32 phasemask, const G3D::Ray&
 {
     float distance = maxDist;
     DynamicTreeIntersectionCallback callback(phasemask);
-    impl->intersectRay(ray, callback, distance, endPos);
+    // the nearest hit, the ray is not cut at the first object it meets
+    impl->intersectRay(ray, callback, distance, false);
     if (callback.didHit())
         maxDist = distance;
     return callback.didHit();
@@ -241,17 +177,24 @@ bool DynamicMapTree::isInLineOfSight(float x1, float y1, float z1, float x2, flo
 
     G3D::Ray r(v1, (v2-v1) / maxDist);
     DynamicTreeIntersectionCallback callback(phasemask);
-    impl->intersectRay(r, callback, maxDist, v2);
+    impl->intersectRay(r, callback, maxDist, true);
 
     return !callback.did_hit;
 }
 
+void DynamicMapTree::isInLineOfSight(std::vector<VMAP::LineOfSightRay>& rays) const
+{
+    for (std::vector<VMAP::LineOfSightRay>::iterator ray = rays.begin(); ray != rays.end(); ++ray)
+        if (ray->inLineOfSight)
+            ray->inLineOfSight = isInLineOfSight(ray->x1, ray->y1, ray->z1, ray->x2, ray->y2, ray->z2, ray->phaseMask);
+}
+
 float DynamicMapTree::getHeight(float x, float y, float z, float maxSearchDist, uint32 phasemask) const
 {
     G3D::Vector3 v(x, y, z);
     G3D::Ray r(v, G3D::Vector3(0, 0, -1));
     DynamicTreeIntersectionCallback callback(phasemask);
-    impl->intersectZAllignedRay(r, callback, maxSearchDist);
+    impl->intersectRay(r, callback, maxSearchDist, false);
 
     if (callback.didHit())
         return v.z - maxSearchDist;
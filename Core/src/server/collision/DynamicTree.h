@@ -21,6 +21,7 @@
 #define _DYNTREE_H
 
 #include "Define.h"
+#include <vector>
 
 namespace G3D
 {
@@ -28,6 +29,11 @@ namespace G3D
     class Vector3;
 }
 
+namespace VMAP
+{
+    struct LineOfSightRay;
+}
+
 class GameObjectModel;
 struct DynTreeImpl;
 
@@ -42,6 +48,8 @@ public:
 
     bool isInLineOfSight(float x1, float y1, float z1, float x2, float y2,
                          float z2, uint32 phasemask) const;
+    // Only the rays that are still in line of sight are tested
+    void isInLineOfSight(std::vector<VMAP::LineOfSightRay>& rays) const;
 
     bool getIntersectionTime(uint32 phasemask, const G3D::Ray& ray,
                              const G3D::Vector3& endPos, float& maxDist) const;
@@ -54,11 +62,10 @@ public:
 
     void insert(const GameObjectModel&);
     void remove(const GameObjectModel&);
+    // Call after the model moved, it is only reinserted if it left its fat bounds
+    void relocate(const GameObjectModel&);
     bool contains(const GameObjectModel&) const;
     int size() const;
-
-    void balance();
-    void update(uint32 diff);
 };
 
 #endif // _DYNTREE_H
@@ -20,6 +20,7 @@
 #define _IVMAPMANAGER_H
 
 #include <string>
+#include <vector>
 #include "Define.h"
 
 //===========================================================
@@ -41,6 +42,18 @@ namespace VMAP
     #define VMAP_INVALID_HEIGHT       -100000.0f            // for check
     #define VMAP_INVALID_HEIGHT_VALUE -200000.0f            // real assigned value in unknown height case
 
+    // One segment of a batched line of sight query, inLineOfSight holds the result
+    struct LineOfSightRay
+    {
+        LineOfSightRay(float _x1, float _y1, float _z1, float _x2, float _y2, float _z2, uint32 _phaseMask) :
+            x1(_x1), y1(_y1), z1(_z1), x2(_x2), y2(_y2), z2(_z2), phaseMask(_phaseMask), inLineOfSight(true) { }
+
+        float x1, y1, z1;
+        float x2, y2, z2;
+        uint32 phaseMask;           // only used by the dynamic tree
+        bool inLineOfSight;
+    };
+
     //===========================================================
     class IVMapManager
     {
@@ -61,6 +74,10 @@ namespace VMAP
             virtual void unloadMap(unsigned int pMapId) = 0;
 
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) = 0;
+            /**
+            isInLineOfSight for many segments on the same map, the map lookups are done once for the batch
+            */
+            virtual void isInLineOfSight(unsigned int pMapId, std::vector<LineOfSightRay>& pRays) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) = 0;
             /**
             test if we hit an object. return true if we hit one. rx, ry, rz will hold the hit position or the dest position, if no intersection was found
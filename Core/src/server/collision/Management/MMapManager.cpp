@@ -25,8 +25,7 @@ namespace MMAP
     // ######################## MMapManager ########################
     MMapManager::~MMapManager()
     {
-        for (MMapDataSet::iterator i = loadedMMaps.begin(); i != loadedMMaps.end(); ++i)
-            delete i->second;
+        loadedMMaps.clear();
 
         // by now we should not have maps loaded
         // if we had, tiles in MMapData->mmapLoadedTiles, their actual data is lost!
@@ -76,10 +75,10 @@ namespace MMAP
         TC_LOG_INFO("maps", "MMAP:loadMapData: Loaded %03i.mmap", mapId);
 
         // store inside our map list
-        MMapData* mmap_data = new MMapData(mesh);
+        std::shared_ptr<MMapData> mmap_data = std::make_shared<MMapData>(mesh);
         mmap_data->mmapLoadedTiles.clear();
 
-        loadedMMaps.insert(std::pair<uint32, MMapData*>(mapId, mmap_data));
+        loadedMMaps.insert(std::pair<uint32, std::shared_ptr<MMapData> >(mapId, mmap_data));
         return true;
     }
 
@@ -95,7 +94,7 @@ namespace MMAP
             return false;
 
         // get this mmap data
-        MMapData* mmap = loadedMMaps[mapId];
+        MMapData* mmap = loadedMMaps[mapId].get();
         ASSERT(mmap->navMesh);
 
         // check if we already have this tile loaded
@@ -151,8 +150,14 @@ namespace MMAP
         dtMeshHeader* header = (dtMeshHeader*)data;
         dtTileRef tileRef = 0;
 
-        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
-        if (dtStatusSucceed(mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef)))
+        dtStatus status;
+        {
+            boost::unique_lock<boost::shared_mutex> lock(mmap->tileLock);
+            // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
+            status = mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef);
+        }
+
+        if (dtStatusSucceed(status))
         {
             mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
             ++loadedTiles;
@@ -179,7 +184,7 @@ namespace MMAP
             return false;
         }
 
-        MMapData* mmap = loadedMMaps[mapId];
+        MMapData* mmap = loadedMMaps[mapId].get();
 
         // check if we have this tile loaded
         uint32 packedGridPos = packTileID(x, y);
@@ -192,8 +197,14 @@ namespace MMAP
 
         dtTileRef tileRef = mmap->mmapLoadedTiles[packedGridPos];
 
+        dtStatus status;
+        {
+            boost::unique_lock<boost::shared_mutex> lock(mmap->tileLock);
+            status = mmap->navMesh->removeTile(tileRef, NULL, NULL);
+        }
+
         // unload, and mark as non loaded
-        if (dtStatusFailed(mmap->navMesh->removeTile(tileRef, NULL, NULL)))
+        if (dtStatusFailed(status))
         {
             // this is technically a memory leak
             // if the grid is later reloaded, dtNavMesh::addTile will return error but no extra memory is used
@@ -222,68 +233,71 @@ namespace MMAP
         }
 
         // unload all tiles from given map
-        MMapData* mmap = loadedMMaps[mapId];
-        for (MMapTileSet::iterator i = mmap->mmapLoadedTiles.begin(); i != mmap->mmapLoadedTiles.end(); ++i)
+        MMapData* mmap = loadedMMaps[mapId].get();
         {
-            uint32 x = (i->first >> 16);
-            uint32 y = (i->first & 0x0000FFFF);
-            if (dtStatusFailed(mmap->navMesh->removeTile(i->second, NULL, NULL)))
-                TC_LOG_ERROR("maps", "MMAP:unloadMap: Could not unload %03u%02i%02i.mmtile from navmesh", mapId, x, y);
-            else
+            // pathfinding threads may still be searching this navmesh
+            boost::unique_lock<boost::shared_mutex> lock(mmap->tileLock);
+            for (MMapTileSet::iterator i = mmap->mmapLoadedTiles.begin(); i != mmap->mmapLoadedTiles.end(); ++i)
             {
-                --loadedTiles;
-                TC_LOG_INFO("maps", "MMAP:unloadMap: Unloaded mmtile %03i[%02i, %02i] from %03i", mapId, x, y, mapId);
+                uint32 x = (i->first >> 16);
+                uint32 y = (i->first & 0x0000FFFF);
+                if (dtStatusFailed(mmap->navMesh->removeTile(i->second, NULL, NULL)))
+                    TC_LOG_ERROR("maps", "MMAP:unloadMap: Could not unload %03u%02i%02i.mmtile from navmesh", mapId, x, y);
+                else
+                {
+                    --loadedTiles;
+                    TC_LOG_INFO("maps", "MMAP:unloadMap: Unloaded mmtile %03i[%02i, %02i] from %03i", mapId, x, y, mapId);
+                }
             }
+
+            mmap->mmapLoadedTiles.clear();
         }
 
-        delete mmap;
+        // the navmesh itself is freed with the last pending pathfinding request that still holds it
         loadedMMaps.erase(mapId);
         TC_LOG_INFO("maps", "MMAP:unloadMap: Unloaded %03i.mmap", mapId);
 
         return true;
     }
 
-    bool MMapManager::unloadMapInstance(uint32 mapId, uint32 instanceId)
+    dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
     {
-        // check if we have this map loaded
         if (loadedMMaps.find(mapId) == loadedMMaps.end())
-        {
-            // file may not exist, therefore not loaded
-            TC_LOG_DEBUG("maps", "MMAP:unloadMapInstance: Asked to unload not loaded navmesh map %03u", mapId);
-            return false;
-        }
-
-        MMapData* mmap = loadedMMaps[mapId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
-        {
-            TC_LOG_DEBUG("maps", "MMAP:unloadMapInstance: Asked to unload not loaded dtNavMeshQuery mapId %03u instanceId %u", mapId, instanceId);
-            return false;
-        }
-
-        dtNavMeshQuery* query = mmap->navMeshQueries[instanceId];
-
-        dtFreeNavMeshQuery(query);
-        mmap->navMeshQueries.erase(instanceId);
-        TC_LOG_INFO("maps", "MMAP:unloadMapInstance: Unloaded mapId %03u instanceId %u", mapId, instanceId);
+            return NULL;
 
-        return true;
+        return loadedMMaps[mapId]->navMesh;
     }
 
-    dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
+    std::shared_ptr<MMapData> MMapManager::GetNavMeshData(uint32 mapId)
     {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
-            return NULL;
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
+            return std::shared_ptr<MMapData>();
 
-        return loadedMMaps[mapId]->navMesh;
+        return itr->second;
     }
 
-    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
+    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId)
     {
         if (loadedMMaps.find(mapId) == loadedMMaps.end())
             return NULL;
 
-        MMapData* mmap = loadedMMaps[mapId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
+        if (!threadQueries.get())
+            threadQueries.reset(new ThreadNavMeshQueries());
+
+        MMapData* mmap = loadedMMaps[mapId].get();
+        NavMeshQuerySet& queries = threadQueries->queries;
+        NavMeshQuerySet::iterator itr = queries.find(mapId);
+
+        // the map may have been unloaded and loaded again since this thread made its query
+        if (itr != queries.end() && itr->second->getAttachedNavMesh() != mmap->navMesh)
+        {
+            dtFreeNavMeshQuery(itr->second);
+            queries.erase(itr);
+            itr = queries.end();
+        }
+
+        if (itr == queries.end())
         {
             // allocate mesh query
             dtNavMeshQuery* query = dtAllocNavMeshQuery();
@@ -291,14 +305,14 @@ namespace MMAP
             if (dtStatusFailed(query->init(mmap->navMesh, 1024)))
             {
                 dtFreeNavMeshQuery(query);
-                TC_LOG_ERROR("maps", "MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
+                TC_LOG_ERROR("maps", "MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u", mapId);
                 return NULL;
             }
 
-            TC_LOG_INFO("maps", "MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-            mmap->navMeshQueries.insert(std::pair<uint32, dtNavMeshQuery*>(instanceId, query));
+            TC_LOG_DEBUG("maps", "MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %03u", mapId);
+            itr = queries.insert(std::pair<uint32, dtNavMeshQuery*>(mapId, query)).first;
         }
 
-        return mmap->navMeshQueries[instanceId];
+        return itr->second;
     }
 }
@@ -23,6 +23,10 @@
 #include "DetourAlloc.h"
 #include "DetourNavMesh.h"
 #include "DetourNavMeshQuery.h"
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -38,22 +42,32 @@ namespace MMAP
         MMapData(dtNavMesh* mesh) : navMesh(mesh) { }
         ~MMapData()
         {
-            for (NavMeshQuerySet::iterator i = navMeshQueries.begin(); i != navMeshQueries.end(); ++i)
-                dtFreeNavMeshQuery(i->second);
-
             if (navMesh)
                 dtFreeNavMesh(navMesh);
         }
 
         dtNavMesh* navMesh;
-
-        // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
-        NavMeshQuerySet navMeshQueries;     // instanceId to query
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
+
+        // held exclusively while tiles are added or removed, pathfinding threads hold it shared while they search
+        boost::shared_mutex tileLock;
     };
 
+    // pathfinding requests keep a reference, the navmesh and its lock outlive unloadMap until they are done
+    typedef std::unordered_map<uint32, std::shared_ptr<MMapData> > MMapDataSet;
+
+    // dtNavMeshQuery is not thread safe, every thread that searches paths owns one per map
+    // instead of one per map instance, the tiles themselves are shared by all instances anyway
+    struct ThreadNavMeshQueries
+    {
+        ~ThreadNavMeshQueries()
+        {
+            for (NavMeshQuerySet::iterator i = queries.begin(); i != queries.end(); ++i)
+                dtFreeNavMeshQuery(i->second);
+        }
 
-    typedef std::unordered_map<uint32, MMapData*> MMapDataSet;
+        NavMeshQuerySet queries;            // mapId to query
+    };
 
     // singleton class
     // holds all all access to mmap loading unloading and meshes
@@ -66,11 +80,11 @@ namespace MMAP
             bool loadMap(const std::string& basePath, uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId);
-            bool unloadMapInstance(uint32 mapId, uint32 instanceId);
 
-            // the returned [dtNavMeshQuery const*] is NOT threadsafe
-            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
+            // the returned [dtNavMeshQuery const*] belongs to the calling thread
+            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
+            std::shared_ptr<MMapData> GetNavMeshData(uint32 mapId);
 
             uint32 getLoadedTilesCount() const { return loadedTiles; }
             uint32 getLoadedMapsCount() const { return loadedMMaps.size(); }
@@ -80,6 +94,7 @@ namespace MMAP
 
             MMapDataSet loadedMMaps;
             uint32 loadedTiles;
+            boost::thread_specific_ptr<ThreadNavMeshQueries> threadQueries;
     };
 }
 
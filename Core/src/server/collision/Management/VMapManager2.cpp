@@ -151,6 +151,27 @@ namespace VMAP
         return true;
     }
 
+    void VMapManager2::isInLineOfSight(unsigned int mapId, std::vector<LineOfSightRay>& rays)
+    {
+        if (!isLineOfSightCalcEnabled() || DisableMgr::IsDisabledFor(DISABLE_TYPE_VMAP, mapId, NULL, VMAP_DISABLE_LOS))
+            return;
+
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(mapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return;
+
+        for (std::vector<LineOfSightRay>::iterator ray = rays.begin(); ray != rays.end(); ++ray)
+        {
+            if (!ray->inLineOfSight)
+                continue;
+
+            Vector3 pos1 = convertPositionToInternalRep(ray->x1, ray->y1, ray->z1);
+            Vector3 pos2 = convertPositionToInternalRep(ray->x2, ray->y2, ray->z2);
+            if (pos1 != pos2)
+                ray->inLineOfSight = instanceTree->second->isInLineOfSight(pos1, pos2);
+        }
+    }
+
     /**
     get the hit position and return true if we hit something
     otherwise the result pos will be the dest pos
@@ -336,6 +336,7 @@ namespace VMAP
         }
         iLoadedSpawns.clear();
         iLoadedTiles.clear();
+        iTileSpawns.clear();
     }
 
     //=========================================================
@@ -367,6 +368,8 @@ namespace VMAP
             uint32 numSpawns = 0;
             if (result && fread(&numSpawns, sizeof(uint32), 1, tf) != 1)
                 result = false;
+            tileSpawnList& tileSpawns = iTileSpawns[packTileID(tileX, tileY)];
+            tileSpawns.reserve(numSpawns);
             for (uint32 i=0; i<numSpawns && result; ++i)
             {
                 // read model spawns
@@ -384,6 +387,7 @@ namespace VMAP
 
                     if (fread(&referencedVal, sizeof(uint32), 1, tf) == 1)
                     {
+                        tileSpawns.push_back(std::make_pair(referencedVal, model ? spawn.name : std::string()));
                         if (!iLoadedSpawns.count(referencedVal))
                         {
 #ifdef VMAP_DEBUG
@@ -408,7 +412,11 @@ namespace VMAP
                         }
                     }
                     else
+                    {
+                        if (model)
+                            vm->releaseModelInstance(spawn.name);
                         result = false;
+                    }
                 }
             }
             iLoadedTiles[packTileID(tileX, tileY)] = true;
@@ -430,48 +438,26 @@ namespace VMAP
             VMAP_ERROR_LOG("misc", "StaticMapTree::UnloadMapTile() : trying to unload non-loaded tile - Map:%u X:%u Y:%u", iMapID, tileX, tileY);
             return;
         }
-        if (tile->second) // file associated with tile
+        tileSpawnMap::iterator spawns = iTileSpawns.find(tileID);
+        if (spawns != iTileSpawns.end()) // file associated with tile
         {
-            std::string tilefile = iBasePath + getTileFileName(iMapID, tileX, tileY);
-            FILE* tf = fopen(tilefile.c_str(), "rb");
-            if (tf)
+            for (tileSpawnList::const_iterator itr = spawns->second.begin(); itr != spawns->second.end(); ++itr)
             {
-                bool result=true;
-                char chunk[8];
-                if (!readChunk(tf, chunk, VMAP_MAGIC, 8))
-                    result = false;
-                uint32 numSpawns;
-                if (fread(&numSpawns, sizeof(uint32), 1, tf) != 1)
-                    result = false;
-                for (uint32 i=0; i<numSpawns && result; ++i)
+                // release model instance
+                if (!itr->second.empty())
+                    vm->releaseModelInstance(itr->second);
+
+                // update tree
+                uint32 referencedNode = itr->first;
+                if (!iLoadedSpawns.count(referencedNode))
+                    VMAP_ERROR_LOG("misc", "StaticMapTree::UnloadMapTile() : trying to unload non-referenced model '%s' (node:%u)", itr->second.c_str(), referencedNode);
+                else if (--iLoadedSpawns[referencedNode] == 0)
                 {
-                    // read model spawns
-                    ModelSpawn spawn;
-                    result = ModelSpawn::readFromFile(tf, spawn);
-                    if (result)
-                    {
-                        // release model instance
-                        vm->releaseModelInstance(spawn.name);
-
-                        // update tree
-                        uint32 referencedNode;
-
-                        if (fread(&referencedNode, sizeof(uint32), 1, tf) != 1)
-                            result = false;
-                        else
-                        {
-                            if (!iLoadedSpawns.count(referencedNode))
-                            VMAP_ERROR_LOG("misc", "StaticMapTree::UnloadMapTile() : trying to unload non-referenced model '%s' (ID:%u)", spawn.name.c_str(), spawn.ID);
-                            else if (--iLoadedSpawns[referencedNode] == 0)
-                            {
-                                iTreeValues[referencedNode].setUnloaded();
-                                iLoadedSpawns.erase(referencedNode);
-                            }
-                        }
-                    }
+                    iTreeValues[referencedNode].setUnloaded();
+                    iLoadedSpawns.erase(referencedNode);
                 }
-                fclose(tf);
             }
+            iTileSpawns.erase(spawns);
         }
         iLoadedTiles.erase(tile);
     }
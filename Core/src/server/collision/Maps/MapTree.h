@@ -21,7 +21,9 @@
 
 #include "Define.h"
 #include "BoundingIntervalHierarchy.h"
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace VMAP
 {
@@ -41,6 +43,9 @@ namespace VMAP
     {
         typedef std::unordered_map<uint32, bool> loadedTileMap;
         typedef std::unordered_map<uint32, uint32> loadedSpawnMap;
+        // <tree_index, model name> of every spawn a tile referenced, name is empty if the model failed to load
+        typedef std::vector<std::pair<uint32, std::string> > tileSpawnList;
+        typedef std::unordered_map<uint32, tileSpawnList> tileSpawnMap;
         private:
             uint32 iMapID;
             bool iIsTiled;
@@ -54,6 +59,8 @@ namespace VMAP
             loadedTileMap iLoadedTiles;
             // stores <tree_index, reference_count> to invalidate tree values, unload map, and to be able to report errors
             loadedSpawnMap iLoadedSpawns;
+            // spawns of the loaded tiles, so unloading a tile does not have to read its file again
+            tileSpawnMap iTileSpawns;
             std::string iBasePath;
 
         private:
@@ -150,7 +150,8 @@ m_lootRecipient(), m_lootRecipientGroup(0), _skinner(), _pickpocketLootRestore(0
 m_respawnDelay(300), m_corpseDelay(60), m_respawnradius(0.0f), m_reactState(REACT_AGGRESSIVE),
 m_defaultMovementType(IDLE_MOTION_TYPE), m_DBTableGuid(0), m_equipmentId(0), m_originalEquipmentId(0), m_AlreadyCallAssistance(false),
 m_AlreadySearchedAssistance(false), m_regenHealth(true), m_AI_locked(false), m_meleeDamageSchoolMask(SPELL_SCHOOL_MASK_NORMAL),
-m_originalEntry(0), m_homePosition(), m_transportHomePosition(), m_creatureInfo(NULL), m_creatureData(NULL), m_waypointID(0), m_path_id(0), m_formation(NULL)
+m_originalEntry(0), m_homePosition(), m_transportHomePosition(), m_creatureInfo(NULL), m_creatureData(NULL), m_waypointID(0), m_path_id(0), m_formation(NULL),
+_movementLodTimer(0), _movementLodDiff(0), _movementLodObserved(true)
 {
     m_regenTimer = CREATURE_REGEN_INTERVAL;
     m_valuesCount = UNIT_END;
@@ -2661,6 +2662,57 @@ void Creature::UpdateMovementFlags()
     SetSwim(GetCreatureTemplate()->InhabitType & INHABIT_WATER && IsInWater());
 }
 
+bool Creature::UpdateMovementLod(uint32 diff, uint32& movementDiff)
+{
+    uint32 interval = sWorld->getIntConfig(CONFIG_CREATURE_MOVEMENT_LOD_INTERVAL);
+
+    // anything a player may be interacting with, or that moves something else along, keeps the full rate
+    if (!interval || IsInCombat() || isActiveObject() || GetCharmerOrOwnerGUID() || GetTransport() || IsVehicle() || GetVehicle())
+    {
+        movementDiff = _movementLodDiff + diff;
+        _movementLodDiff = 0;
+        return true;
+    }
+
+    _movementLodDiff += diff;
+    if (_movementLodTimer <= diff)
+    {
+        _movementLodTimer = interval;
+        _movementLodObserved = HasMovementObserver();
+    }
+    else
+    {
+        _movementLodTimer -= diff;
+        if (!_movementLodObserved)
+            return false;
+    }
+
+    movementDiff = _movementLodDiff;
+    _movementLodDiff = 0;
+    return true;
+}
+
+void Creature::WakeMovementLod()
+{
+    // the held back time is caught up with the next update
+    _movementLodObserved = true;
+    _movementLodTimer = 0;
+}
+
+bool Creature::HasMovementObserver() const
+{
+    struct PlayerFound
+    {
+        PlayerFound() : found(false) { }
+        void operator()(WorldObject* /*player*/) { found = true; }
+        bool found;
+    } check;
+
+    // any phase counts, a creature only seen from another phase just moves at the full rate
+    GetMap()->VisitPlayersInRange3d(GetPositionX(), GetPositionY(), GetPositionZ(), GetVisibilityRange(), check);
+    return check.found;
+}
+
 void Creature::SetObjectScale(float scale)
 {
     Unit::SetObjectScale(scale);
@@ -508,6 +508,10 @@ class Creature : public Unit, public GridObject<Creature>, public MapObject
 
         void UpdateMovementFlags();
 
+        // Returns false while the movement of a creature nobody can see is held back, movementDiff gets the time to catch up otherwise
+        bool UpdateMovementLod(uint32 diff, uint32& movementDiff);
+        void WakeMovementLod();
+
         bool UpdateStats(Stats stat) override;
         bool UpdateAllStats() override;
         void UpdateResistances(uint32 school) override;
@@ -743,6 +747,12 @@ class Creature : public Unit, public GridObject<Creature>, public MapObject
         bool TriggerJustRespawned;
 
         Spell const* _focusSpell;   ///> Locks the target during spell cast for proper facing
+
+        bool HasMovementObserver() const;
+
+        uint32 _movementLodTimer;
+        uint32 _movementLodDiff;    ///> Movement time held back since the last step
+        bool _movementLodObserved;
 };
 
 class AssistDelayEvent : public BasicEvent
@@ -2107,6 +2107,8 @@ void GameObject::EnableCollision(bool enable)
         GetMap()->InsertGameObjectModel(*m_model);*/
 
     m_model->enable(enable ? GetPhaseMask() : 0);
+    if (IsInWorld())
+        GetMap()->InvalidateLineOfSightCache(m_model->getBounds());
 }
 
 void GameObject::UpdateModel()
@@ -2298,8 +2300,8 @@ void GameObject::UpdateModelPosition()
 
     if (GetMap()->ContainsGameObjectModel(*m_model))
     {
-        GetMap()->RemoveGameObjectModel(*m_model);
+        G3D::AABox oldBounds = m_model->getBounds();
         m_model->Relocate(*this);
-        GetMap()->InsertGameObjectModel(*m_model);
+        GetMap()->RelocateGameObjectModel(*m_model, oldBounds);
     }
 }
@@ -1119,7 +1119,8 @@ elunaEvents(new ElunaEventProcessor(this)),
 #endif
 m_name(""), m_isActive(false), m_isWorldObject(isWorldObject), m_zoneScript(NULL),
 m_transport(NULL), m_currMap(NULL), m_InstanceId(0),
-m_phaseMask(PHASEMASK_NORMAL), m_notifyflags(0), m_executed_notifies(0)
+m_phaseMask(PHASEMASK_NORMAL), m_notifyflags(0), m_executed_notifies(0),
+m_positionIndex(NULL), m_positionIndexBucket(0), m_positionIndexSlot(0)
 {
     m_serverSideVisibility.SetValue(SERVERSIDE_VISIBILITY_GHOST, GHOST_VISIBILITY_ALIVE | GHOST_VISIBILITY_GHOST);
     m_serverSideVisibilityDetect.SetValue(SERVERSIDE_VISIBILITY_GHOST, GHOST_VISIBILITY_ALIVE);
@@ -1597,62 +1598,50 @@ void WorldObject::UpdateGroundPositionZ(float x, float y, float &z) const
         z = new_z + 0.05f;                                   // just to be sure that we are not a few pixel under the surface
 }
 
+AllowedPositionZRule WorldObject::GetAllowedPositionZRule() const
+{
+    // non fly unit don't must be in air
+    // non swim unit must be at ground (mostly speedup, because it don't must be in water and water level check less fast
+    if (Creature const* creature = ToCreature())
+    {
+        if (creature->CanFly())
+            return ALLOWED_Z_ABOVE_GROUND;
+        return creature->CanSwim() ? ALLOWED_Z_WATER_OR_GROUND : ALLOWED_Z_SNAP_TO_GROUND;
+    }
+
+    // for server controlled moves playr work same as creature (but it can always swim)
+    if (Player const* player = ToPlayer())
+        return player->CanFly() ? ALLOWED_Z_ABOVE_GROUND : ALLOWED_Z_WATER_OR_GROUND;
+
+    return ALLOWED_Z_SNAP_TO_GROUND;
+}
+
 void WorldObject::UpdateAllowedPositionZ(float x, float y, float &z) const
 {
     // TODO: Allow transports to be part of dynamic vmap tree
     if (GetTransport())
         return;
 
-    switch (GetTypeId())
+    switch (GetAllowedPositionZRule())
     {
-        case TYPEID_UNIT:
+        case ALLOWED_Z_WATER_OR_GROUND:
         {
-            // non fly unit don't must be in air
-            // non swim unit must be at ground (mostly speedup, because it don't must be in water and water level check less fast
-            if (!ToCreature()->CanFly())
+            float ground_z = z;
+            float max_z = GetMap()->GetWaterOrGroundLevel(x, y, z, &ground_z, !ToUnit()->HasAuraType(SPELL_AURA_WATER_WALK));
+            if (max_z > INVALID_HEIGHT)
             {
-                bool canSwim = ToCreature()->CanSwim();
-                float ground_z = z;
-                float max_z = canSwim
-                    ? GetMap()->GetWaterOrGroundLevel(x, y, z, &ground_z, !ToUnit()->HasAuraType(SPELL_AURA_WATER_WALK))
-                    : ((ground_z = GetMap()->GetHeight(GetPhaseMask(), x, y, z, true)));
-                if (max_z > INVALID_HEIGHT)
-                {
-                    if (z > max_z)
-                        z = max_z;
-                    else if (z < ground_z)
-                        z = ground_z;
-                }
-            }
-            else
-            {
-                float ground_z = GetMap()->GetHeight(GetPhaseMask(), x, y, z, true);
-                if (z < ground_z)
+                if (z > max_z)
+                    z = max_z;
+                else if (z < ground_z)
                     z = ground_z;
             }
             break;
         }
-        case TYPEID_PLAYER:
+        case ALLOWED_Z_ABOVE_GROUND:
         {
-            // for server controlled moves playr work same as creature (but it can always swim)
-            if (!ToPlayer()->CanFly())
-            {
-                float ground_z = z;
-                float max_z = GetMap()->GetWaterOrGroundLevel(x, y, z, &ground_z, !ToUnit()->HasAuraType(SPELL_AURA_WATER_WALK));
-                if (max_z > INVALID_HEIGHT)
-                {
-                    if (z > max_z)
-                        z = max_z;
-                    else if (z < ground_z)
-                        z = ground_z;
-                }
-            }
-            else
-            {
-                float ground_z = GetMap()->GetHeight(GetPhaseMask(), x, y, z, true);
-                if (z < ground_z)
-                    z = ground_z;
-            }
+            float ground_z = GetMap()->GetHeight(GetPhaseMask(), x, y, z, true);
+            if (z < ground_z)
+                z = ground_z;
             break;
         }
         default:
@@ -1665,6 +1654,36 @@ void WorldObject::UpdateAllowedPositionZ(float x, float y, float &z) const
     }
 }
 
+void WorldObject::UpdateAllowedPositionZ(std::vector<G3D::Vector3>& points) const
+{
+    // TODO: Allow transports to be part of dynamic vmap tree
+    if (GetTransport())
+        return;
+
+    // swimmers check the water level of every point on its own
+    AllowedPositionZRule rule = GetAllowedPositionZRule();
+    if (rule == ALLOWED_Z_WATER_OR_GROUND)
+    {
+        for (std::vector<G3D::Vector3>::iterator itr = points.begin(); itr != points.end(); ++itr)
+            UpdateAllowedPositionZ(itr->x, itr->y, itr->z);
+        return;
+    }
+
+    // same rules as for a single point, the ground under all points is looked up at once
+    std::vector<float> heights;
+    GetMap()->GetHeights(GetPhaseMask(), points, heights, true);
+    for (uint32 i = 0; i < points.size(); ++i)
+    {
+        if (rule == ALLOWED_Z_ABOVE_GROUND)
+        {
+            if (points[i].z < heights[i])
+                points[i].z = heights[i];
+        }
+        else if (heights[i] > INVALID_HEIGHT)
+            points[i].z = heights[i];
+    }
+}
+
 bool Position::IsPositionValid() const
 {
     return Trinity::IsValidMapCoord(m_positionX, m_positionY, m_positionZ, m_orientation);
@@ -1929,13 +1948,13 @@ void WorldObject::SendMessageToSet(WorldPacket* data, bool self)
 void WorldObject::SendMessageToSetInRange(WorldPacket* data, float dist, bool /*self*/)
 {
     Trinity::MessageDistDeliverer notifier(this, data, dist);
-    VisitNearbyWorldObject(dist, notifier);
+    notifier.Deliver(dist);
 }
 
 void WorldObject::SendMessageToSet(WorldPacket* data, Player const* skipped_rcvr)
 {
     Trinity::MessageDistDeliverer notifier(this, data, GetVisibilityRange(), false, skipped_rcvr);
-    VisitNearbyWorldObject(GetVisibilityRange(), notifier);
+    notifier.Deliver(GetVisibilityRange());
 }
 
 void WorldObject::SendObjectDeSpawnAnim(ObjectGuid guid)
@@ -2566,6 +2585,7 @@ void WorldObject::MovePositionToFirstCollision(Position &pos, float dist, float
 void WorldObject::SetPhaseMask(uint32 newPhaseMask, bool update)
 {
     m_phaseMask = newPhaseMask;
+    UpdatePositionIndex();
 
     if (update && IsInWorld())
         UpdateObjectVisibility();
@@ -22,6 +22,7 @@
 #include "Common.h"
 #include "UpdateMask.h"
 #include "GridReference.h"
+#include "CellPositionIndex.h"
 #include "ObjectDefines.h"
 #include "Map.h"
 
@@ -514,6 +515,14 @@ class FlaggedValuesArray32
         T_FLAGS m_flags;
 };
 
+// How UpdateAllowedPositionZ moves a point of a server controlled move
+enum AllowedPositionZRule
+{
+    ALLOWED_Z_SNAP_TO_GROUND,       // onto the ground
+    ALLOWED_Z_ABOVE_GROUND,         // up to the ground if below it, flyers
+    ALLOWED_Z_WATER_OR_GROUND,      // between the ground and the water surface, swimmers
+};
+
 enum MapObjectCellMoveState
 {
     MAP_OBJECT_CELL_MOVE_NONE, //not in move list
@@ -571,12 +580,17 @@ class WorldObject : public Object, public WorldLocation
         float GetObjectSize() const;
         void UpdateGroundPositionZ(float x, float y, float &z) const;
         void UpdateAllowedPositionZ(float x, float y, float &z) const;
+        void UpdateAllowedPositionZ(std::vector<G3D::Vector3>& points) const;
 
         void GetRandomPoint(Position const &srcPos, float distance, float &rand_x, float &rand_y, float &rand_z) const;
         Position GetRandomPoint(Position const &srcPos, float distance) const;
 
         uint32 GetInstanceId() const { return m_InstanceId; }
 
+        // refresh or drop the copy kept by the cell's packed position index, called by Map at the grid add/remove/relocate points
+        void UpdatePositionIndex() { if (m_positionIndex) m_positionIndex->Update(this); }
+        void RemoveFromPositionIndex() { if (m_positionIndex) m_positionIndex->Remove(this); }
+
         virtual void SetPhaseMask(uint32 newPhaseMask, bool update);
         uint32 GetPhaseMask() const { return m_phaseMask; }
         bool InSamePhase(WorldObject const* obj) const;
@@ -750,6 +764,7 @@ class WorldObject : public Object, public WorldLocation
         virtual bool IsInvisibleDueToDespawn() const { return false; }
         //difference from IsAlwaysVisibleFor: 1. after distance check; 2. use owner or charmer as seer
         virtual bool IsAlwaysDetectableFor(WorldObject const* /*seer*/) const { return false; }
+
     private:
         Map* m_currMap;                                    //current object's Map location
 
@@ -759,8 +774,15 @@ class WorldObject : public Object, public WorldLocation
 
         uint16 m_notifyflags;
         uint16 m_executed_notifies;
+
+        friend class CellPositionIndex;
+        CellPositionIndex* m_positionIndex;                 // packed index of the cell we are linked in, if it keeps one
+        uint32 m_positionIndexBucket;
+        uint32 m_positionIndexSlot;
         virtual bool _IsWithinDist(WorldObject const* obj, float dist2compare, bool is3D) const;
 
+        AllowedPositionZRule GetAllowedPositionZRule() const;
+
         bool CanNeverSee(WorldObject const* obj) const;
         virtual bool CanAlwaysSee(WorldObject const* /*obj*/) const { return false; }
         bool CanDetect(WorldObject const* obj, bool ignoreStealth) const;
@@ -43,6 +43,14 @@ void UpdateData::AddUpdateBlock(const ByteBuffer &block)
     ++m_blockCount;
 }
 
+void UpdateData::Append(UpdateData& right)
+{
+    m_outOfRangeGUIDs.insert(right.m_outOfRangeGUIDs.begin(), right.m_outOfRangeGUIDs.end());
+    m_data.append(right.m_data);
+    m_blockCount += right.m_blockCount;
+    right.Clear();
+}
+
 void UpdateData::Compress(void* dst, uint32 *dst_size, void* src, int src_size)
 {
     z_stream c_stream;
@@ -2449,6 +2449,10 @@ void Player::RemoveFromWorld()
     ///- The player should only be removed when logging out
     Unit::RemoveFromWorld();
 
+    // gathered changes are about the objects of the map being left
+    m_deferredVisibility.Clear();
+    m_deferredVisibleNow.clear();
+
     for (uint8 i = PLAYER_SLOT_START; i < PLAYER_SLOT_END; ++i)
     {
         if (m_items[i])
@@ -6765,7 +6769,7 @@ void Player::SendMessageToSetInRange(WorldPacket* data, float dist, bool self)
         GetSession()->SendPacket(data);
 
     Trinity::MessageDistDeliverer notifier(this, data, dist);
-    VisitNearbyWorldObject(dist, notifier);
+    notifier.Deliver(dist);
 }
 
 void Player::SendMessageToSetInRange(WorldPacket* data, float dist, bool self, bool own_team_only)
@@ -6774,7 +6778,7 @@ void Player::SendMessageToSetInRange(WorldPacket* data, float dist, bool self, b
         GetSession()->SendPacket(data);
 
     Trinity::MessageDistDeliverer notifier(this, data, dist, own_team_only);
-    VisitNearbyWorldObject(dist, notifier);
+    notifier.Deliver(dist);
 }
 
 void Player::SendMessageToSet(WorldPacket* data, Player const* skipped_rcvr)
@@ -6785,7 +6789,7 @@ void Player::SendMessageToSet(WorldPacket* data, Player const* skipped_rcvr)
     // we use World::GetMaxVisibleDistance() because i cannot see why not use a distance
     // update: replaced by GetMap()->GetVisibilityDistance()
     Trinity::MessageDistDeliverer notifier(this, data, GetVisibilityRange(), false, skipped_rcvr);
-    VisitNearbyWorldObject(GetVisibilityRange(), notifier);
+    notifier.Deliver(GetVisibilityRange());
 }
 
 void Player::SendDirectMessage(WorldPacket* data)
@@ -22512,13 +22516,13 @@ bool Player::IsVisibleGloballyFor(Player const* u) const
 }
 
 template<class T>
-inline void UpdateVisibilityOf_helper(GuidSet& s64, T* target, std::set<Unit*>& /*v*/)
+inline void UpdateVisibilityOf_helper(GuidSet& s64, T* target, std::vector<Unit*>& /*v*/)
 {
     s64.insert(target->GetGUID());
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(GuidSet& s64, GameObject* target, std::set<Unit*>& /*v*/)
+inline void UpdateVisibilityOf_helper(GuidSet& s64, GameObject* target, std::vector<Unit*>& /*v*/)
 {
     // @HACK: This is to prevent objects like deeprun tram from disappearing when player moves far from its spawn point while riding it
     if ((target->GetGOInfo()->type != GAMEOBJECT_TYPE_TRANSPORT))
@@ -22526,17 +22530,17 @@ inline void UpdateVisibilityOf_helper(GuidSet& s64, GameObject* target, std::set
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(GuidSet& s64, Creature* target, std::set<Unit*>& v)
+inline void UpdateVisibilityOf_helper(GuidSet& s64, Creature* target, std::vector<Unit*>& v)
 {
     s64.insert(target->GetGUID());
-    v.insert(target);
+    v.push_back(target);
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(GuidSet& s64, Player* target, std::set<Unit*>& v)
+inline void UpdateVisibilityOf_helper(GuidSet& s64, Player* target, std::vector<Unit*>& v)
 {
     s64.insert(target->GetGUID());
-    v.insert(target);
+    v.push_back(target);
 }
 
 template<class T>
@@ -22551,6 +22555,7 @@ inline void BeforeVisibilityDestroy<Creature>(Creature* t, Player* p)
 
 void Player::UpdateVisibilityOf(WorldObject* target)
 {
+    bool deferred = GetMap()->IsDeferringVisibility();
     if (HaveAtClient(target))
     {
         if (!CanSeeOrDetect(target, false, true))
@@ -22558,7 +22563,18 @@ void Player::UpdateVisibilityOf(WorldObject* target)
             if (target->GetTypeId() == TYPEID_UNIT)
                 BeforeVisibilityDestroy<Creature>(target->ToCreature(), this);
 
-            target->DestroyForPlayer(this);
+            // an out of range block goes ahead of the create blocks, a create of the same unit must reach the client first
+            if (deferred && std::find(m_deferredVisibleNow.begin(), m_deferredVisibleNow.end(), target->GetGUID()) != m_deferredVisibleNow.end())
+                SendDeferredVisibility();
+
+            if (deferred && !(target->isType(TYPEMASK_UNIT) && InArena()))
+            {
+                UpdateData data;
+                target->BuildOutOfRangeUpdateBlock(&data);
+                DeferVisibility(data, std::vector<Unit*>());
+            }
+            else
+                target->DestroyForPlayer(this);
             m_clientGUIDs.erase(target->GetGUID());
 
             #ifdef TRINITY_DEBUG
@@ -22570,13 +22586,28 @@ void Player::UpdateVisibilityOf(WorldObject* target)
     {
         if (CanSeeOrDetect(target, false, true))
         {
-            target->SendUpdateToPlayer(this);
             m_clientGUIDs.insert(target->GetGUID());
 
             #ifdef TRINITY_DEBUG
                 TC_LOG_DEBUG("maps", "Object %u (Type: %u) is visible now for player %u. Distance = %f", target->GetGUIDLow(), target->GetTypeId(), GetGUIDLow(), GetDistance(target));
             #endif
 
+            if (Creature* creature = target->ToCreature())
+                creature->WakeMovementLod();
+
+            if (deferred)
+            {
+                UpdateData data;
+                std::vector<Unit*> visibleNow;
+                target->BuildCreateUpdateBlockForPlayer(&data, this);
+                if (target->isType(TYPEMASK_UNIT))
+                    visibleNow.push_back((Unit*)target);
+                DeferVisibility(data, visibleNow);
+                return;
+            }
+
+            target->SendUpdateToPlayer(this);
+
             // target aura duration for caster show only if target exist at caster client
             // send data at target visibility change (adding to client)
             if (target->isType(TYPEMASK_UNIT))
@@ -22585,6 +22616,35 @@ void Player::UpdateVisibilityOf(WorldObject* target)
     }
 }
 
+void Player::DeferVisibility(UpdateData& data, std::vector<Unit*> const& visibleNow)
+{
+    if (!m_deferredVisibility.HasData())
+        GetMap()->AddDeferredVisibility(this);
+
+    m_deferredVisibility.Append(data);
+    for (std::vector<Unit*>::const_iterator itr = visibleNow.begin(); itr != visibleNow.end(); ++itr)
+        m_deferredVisibleNow.push_back((*itr)->GetGUID());
+}
+
+void Player::SendDeferredVisibility()
+{
+    if (!m_deferredVisibility.HasData())
+        return;
+
+    WorldPacket packet;
+    m_deferredVisibility.BuildPacket(&packet);
+    GetSession()->SendPacket(&packet);
+    m_deferredVisibility.Clear();
+
+    // target aura duration for caster show only if target exist at caster client
+    GuidVector visibleNow;
+    visibleNow.swap(m_deferredVisibleNow);
+    for (GuidVector::const_iterator itr = visibleNow.begin(); itr != visibleNow.end(); ++itr)
+        if (Unit* target = ObjectAccessor::GetUnit(*this, *itr))
+            if (HaveAtClient(target))
+                SendInitialVisiblePackets(target);
+}
+
 void Player::UpdateTriggerVisibility()
 {
     if (m_clientGUIDs.empty())
@@ -22638,7 +22698,7 @@ void Player::SendInitialVisiblePackets(Unit* target)
 }
 
 template<class T>
-void Player::UpdateVisibilityOf(T* target, UpdateData& data, std::set<Unit*>& visibleNow)
+void Player::UpdateVisibilityOf(T* target, UpdateData& data, std::vector<Unit*>& visibleNow)
 {
     if (HaveAtClient(target))
     {
@@ -22658,6 +22718,9 @@ void Player::UpdateVisibilityOf(T* target, UpdateData& data, std::set<Unit*>& vi
     {
         if (CanSeeOrDetect(target, false, true))
         {
+            if (Creature* creature = target->ToCreature())
+                creature->WakeMovementLod();
+
             target->BuildCreateUpdateBlockForPlayer(&data, this);
             UpdateVisibilityOf_helper(m_clientGUIDs, target, visibleNow);
 
@@ -22668,11 +22731,11 @@ void Player::UpdateVisibilityOf(T* target, UpdateData& data, std::set<Unit*>& vi
     }
 }
 
-template void Player::UpdateVisibilityOf(Player*        target, UpdateData& data, std::set<Unit*>& visibleNow);
-template void Player::UpdateVisibilityOf(Creature*      target, UpdateData& data, std::set<Unit*>& visibleNow);
-template void Player::UpdateVisibilityOf(Corpse*        target, UpdateData& data, std::set<Unit*>& visibleNow);
-template void Player::UpdateVisibilityOf(GameObject*    target, UpdateData& data, std::set<Unit*>& visibleNow);
-template void Player::UpdateVisibilityOf(DynamicObject* target, UpdateData& data, std::set<Unit*>& visibleNow);
+template void Player::UpdateVisibilityOf(Player*        target, UpdateData& data, std::vector<Unit*>& visibleNow);
+template void Player::UpdateVisibilityOf(Creature*      target, UpdateData& data, std::vector<Unit*>& visibleNow);
+template void Player::UpdateVisibilityOf(Corpse*        target, UpdateData& data, std::vector<Unit*>& visibleNow);
+template void Player::UpdateVisibilityOf(GameObject*    target, UpdateData& data, std::vector<Unit*>& visibleNow);
+template void Player::UpdateVisibilityOf(DynamicObject* target, UpdateData& data, std::vector<Unit*>& visibleNow);
 
 void Player::UpdateObjectVisibility(bool forced)
 {
@@ -22690,6 +22753,7 @@ void Player::UpdateVisibilityForPlayer()
     // updates visibility of all objects around point of view for current player
     Trinity::VisibleNotifier notifier(*this);
     m_seer->VisitNearbyObject(GetSightRange(), notifier);
+    notifier.VisitPlayers(*m_seer, GetSightRange());
     notifier.SendToSelf();   // send gathered data
 }
 
@@ -28,6 +28,7 @@
 #include "QuestDef.h"
 #include "SpellMgr.h"
 #include "Unit.h"
+#include "UpdateData.h"
 
 #include <limits>
 #include <string>
@@ -1109,6 +1110,7 @@ class Player : public Unit, public GridObject<Player>
             Unit::SetObjectScale(scale);
             SetFloatValue(UNIT_FIELD_BOUNDINGRADIUS, scale * DEFAULT_WORLD_OBJECT_SIZE);
             SetFloatValue(UNIT_FIELD_COMBATREACH, scale * DEFAULT_COMBAT_REACH);
+            UpdatePositionIndex();
         }
 
         bool TeleportTo(uint32 mapid, float x, float y, float z, float orientation, uint32 options = 0);
@@ -2126,6 +2128,7 @@ class Player : public Unit, public GridObject<Player>
         void UpdateFallInformationIfNeed(MovementInfo const& minfo, uint16 opcode);
         Unit* m_mover;
         WorldObject* m_seer;
+        Position m_lastVisibilityRelocation;            // where Map::PlayerRelocation last scheduled a visibility update
         void SetFallInformation(uint32 time, float z);
         void HandleFall(MovementInfo const& movementInfo);
 
@@ -2179,7 +2182,9 @@ class Player : public Unit, public GridObject<Player>
         void UpdateTriggerVisibility();
 
         template<class T>
-        void UpdateVisibilityOf(T* target, UpdateData& data, std::set<Unit*>& visibleNow);
+        void UpdateVisibilityOf(T* target, UpdateData& data, std::vector<Unit*>& visibleNow);
+        void DeferVisibility(UpdateData& data, std::vector<Unit*> const& visibleNow);
+        void SendDeferredVisibility();
 
         uint8 m_forced_speed_changes[MAX_MOVE_TYPE];
 
@@ -2519,6 +2524,10 @@ class Player : public Unit, public GridObject<Player>
 
         WorldSession* m_session;
 
+        // visibility changes gathered during the relocation pass of the map
+        UpdateData m_deferredVisibility;
+        GuidVector m_deferredVisibleNow;    // units created by m_deferredVisibility, their initial packets follow it
+
         typedef std::list<Channel*> JoinedChannelsList;
         JoinedChannelsList m_channels;
 
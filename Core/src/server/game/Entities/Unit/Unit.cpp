@@ -370,8 +370,14 @@ void Unit::Update(uint32 p_time)
         ModifyAuraState(AURA_STATE_HEALTH_ABOVE_75_PERCENT, HealthAbovePct(75));
     }
 
-    UpdateSplineMovement(p_time);
-    i_motionMaster->UpdateMotion(p_time);
+    // creatures out of sight of players move in larger, less frequent steps
+    uint32 movementDiff = p_time;
+    if (Creature* creature = ToCreature())
+        if (!creature->UpdateMovementLod(p_time, movementDiff))
+            return;
+
+    UpdateSplineMovement(movementDiff);
+    i_motionMaster->UpdateMotion(movementDiff);
 }
 
 bool Unit::haveOffhandWeapon() const
@@ -3322,6 +3328,20 @@ void Unit::_AddAura(UnitAura* aura, Unit* caster)
     }
 }
 
+// Proc flags ProcDamageAndSpellFor checks an aura against, 0 if it can never proc there
+static uint32 GetAuraProcFlags(SpellInfo const* spellInfo)
+{
+    // handled by the new proc system
+    if (sSpellMgr->GetSpellProcEntry(spellInfo->Id))
+        return 0;
+
+    SpellProcEventEntry const* spellProcEvent = sSpellMgr->GetSpellProcEvent(spellInfo->Id);
+    if (spellProcEvent && spellProcEvent->procFlags)
+        return spellProcEvent->procFlags;
+
+    return spellInfo->ProcFlags;
+}
+
 // creates aura application instance and registers it in lists
 // aura application effects are handled separately to prevent aura list corruption
 AuraApplication * Unit::_CreateAuraApplication(Aura* aura, uint8 effMask)
@@ -3347,6 +3367,9 @@ AuraApplication * Unit::_CreateAuraApplication(Aura* aura, uint8 effMask)
     AuraApplication * aurApp = new AuraApplication(this, caster, aura, effMask);
     m_appliedAuras.insert(AuraApplicationMap::value_type(aurId, aurApp));
 
+    if (uint32 procFlags = GetAuraProcFlags(aurSpellInfo))
+        m_procAuras.insert(ProcAuraMap::value_type(aurId, std::make_pair(procFlags, aurApp)));
+
     if (aurSpellInfo->AuraInterruptFlags)
     {
         m_interruptableAuras.push_back(aurApp);
@@ -3432,6 +3455,15 @@ void Unit::_UnapplyAura(AuraApplicationMap::iterator &i, AuraRemoveMode removeMo
     // Remove all pointers from lists here to prevent possible pointer invalidation on spellcast/auraapply/auraremove
     m_appliedAuras.erase(i);
 
+    for (ProcAuraMap::iterator itr = m_procAuras.lower_bound(aura->GetId()); itr != m_procAuras.end() && itr->first == aura->GetId(); ++itr)
+    {
+        if (itr->second.second == aurApp)
+        {
+            m_procAuras.erase(itr);
+            break;
+        }
+    }
+
     if (aura->GetSpellInfo()->AuraInterruptFlags)
     {
         m_interruptableAuras.remove(aurApp);
@@ -3556,6 +3588,8 @@ void Unit::_RegisterAuraEffect(AuraEffect* aurEff, bool apply)
         m_modAuras[aurEff->GetAuraType()].push_back(aurEff);
     else
         m_modAuras[aurEff->GetAuraType()].remove(aurEff);
+
+    _InvalidateAuraModifierTotals(aurEff->GetAuraType());
 }
 
 // All aura base removes should go threw this function!
@@ -4508,105 +4542,150 @@ uint32 Unit::GetDoTsByCaster(ObjectGuid casterGUID) const
     return dots;
 }
 
-int32 Unit::GetTotalAuraModifier(AuraType auratype) const
+namespace
 {
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    if (mTotalAuraList.empty())
-        return 0;
-
-    std::map<SpellGroup, int32> SameEffectSpellGroup;
-    int32 modifier = 0;
+    struct AnyAuraEffect
+    {
+        bool operator()(AuraEffect const* /*aurEff*/) const { return true; }
+    };
 
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-            modifier += (*i)->GetAmount();
+    struct AuraEffectMiscMask
+    {
+        AuraEffectMiscMask(uint32 miscMask) : _miscMask(miscMask) { }
+        bool operator()(AuraEffect const* aurEff) const { return (aurEff->GetMiscValue() & _miscMask) != 0; }
+        uint32 _miscMask;
+    };
 
-    for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
-        modifier += itr->second;
+    struct AuraEffectMiscValue
+    {
+        AuraEffectMiscValue(int32 miscValue) : _miscValue(miscValue) { }
+        bool operator()(AuraEffect const* aurEff) const { return aurEff->GetMiscValue() == _miscValue; }
+        int32 _miscValue;
+    };
 
-    return modifier;
+    AuraModifierTotals const NoAuraModifiers;
 }
 
-float Unit::GetTotalAuraMultiplier(AuraType auratype) const
+// The unfiltered multiplier never applied the same effect stack rule, the filtered ones do
+template<class Check>
+static void CalculateAuraModifierTotals(Unit::AuraEffectList const& effects, Check const& check, bool sameEffectMultiplier, AuraModifierTotals& totals)
 {
-    float multiplier = 1.0f;
+    std::map<SpellGroup, int32> SameEffectSpellGroup;
+    totals = AuraModifierTotals();
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        AddPct(multiplier, (*i)->GetAmount());
+    for (Unit::AuraEffectList::const_iterator i = effects.begin(); i != effects.end(); ++i)
+    {
+        if (!check(*i))
+            continue;
 
-    return multiplier;
+        int32 amount = (*i)->GetAmount();
+        if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), amount, SameEffectSpellGroup))
+        {
+            totals.total += amount;
+            if (sameEffectMultiplier)
+                AddPct(totals.multiplier, amount);
+        }
+
+        if (!sameEffectMultiplier)
+            AddPct(totals.multiplier, amount);
+
+        if (amount > totals.maxPositive)
+            totals.maxPositive = amount;
+        if (amount < totals.maxNegative)
+            totals.maxNegative = amount;
+    }
+
+    for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
+    {
+        totals.total += itr->second;
+        if (sameEffectMultiplier)
+            AddPct(totals.multiplier, itr->second);
+    }
 }
 
-int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
+AuraModifierTotals const& Unit::GetAuraModifierTotals(AuraType auratype) const
 {
-    int32 modifier = 0;
-
     AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    if (mTotalAuraList.empty())
+        return NoAuraModifiers;
+
+    AuraModifierCache& cache = m_modAuraTotals[auratype];
+    if (!cache.valid)
     {
-        if ((*i)->GetAmount() > modifier)
-            modifier = (*i)->GetAmount();
+        CalculateAuraModifierTotals(mTotalAuraList, AnyAuraEffect(), false, cache.totals);
+        cache.valid = true;
     }
 
-    return modifier;
+    return cache.totals;
 }
 
-int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
+AuraModifierTotals const& Unit::GetAuraModifierTotalsByMiscMask(AuraType auratype, uint32 miscMask) const
 {
-    int32 modifier = 0;
-
     AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetAmount() < modifier)
-            modifier = (*i)->GetAmount();
+    if (mTotalAuraList.empty())
+        return NoAuraModifiers;
 
-    return modifier;
+    std::unordered_map<uint32, AuraModifierTotals>& byMiscMask = m_modAuraTotals[auratype].byMiscMask;
+    std::unordered_map<uint32, AuraModifierTotals>::iterator itr = byMiscMask.find(miscMask);
+    if (itr != byMiscMask.end())
+        return itr->second;
+
+    AuraModifierTotals& totals = byMiscMask[miscMask];
+    CalculateAuraModifierTotals(mTotalAuraList, AuraEffectMiscMask(miscMask), true, totals);
+    return totals;
 }
 
-int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 miscMask) const
+AuraModifierTotals const& Unit::GetAuraModifierTotalsByMiscValue(AuraType auratype, int32 miscValue) const
 {
-    std::map<SpellGroup, int32> SameEffectSpellGroup;
-    int32 modifier = 0;
-
     AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
+    if (mTotalAuraList.empty())
+        return NoAuraModifiers;
 
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetMiscValue() & miscMask)
-            if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-                modifier += (*i)->GetAmount();
+    std::unordered_map<int32, AuraModifierTotals>& byMiscValue = m_modAuraTotals[auratype].byMiscValue;
+    std::unordered_map<int32, AuraModifierTotals>::iterator itr = byMiscValue.find(miscValue);
+    if (itr != byMiscValue.end())
+        return itr->second;
 
-    for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
-        modifier += itr->second;
+    AuraModifierTotals& totals = byMiscValue[miscValue];
+    CalculateAuraModifierTotals(mTotalAuraList, AuraEffectMiscValue(miscValue), true, totals);
+    return totals;
+}
 
-    return modifier;
+int32 Unit::GetTotalAuraModifier(AuraType auratype) const
+{
+    return GetAuraModifierTotals(auratype).total;
 }
 
-float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 miscMask) const
+float Unit::GetTotalAuraMultiplier(AuraType auratype) const
 {
-    std::map<SpellGroup, int32> SameEffectSpellGroup;
-    float multiplier = 1.0f;
+    return GetAuraModifierTotals(auratype).multiplier;
+}
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        if (((*i)->GetMiscValue() & miscMask))
-        {
-            // Check if the Aura Effect has a the Same Effect Stack Rule and if so, use the highest amount of that SpellGroup
-            // If the Aura Effect does not have this Stack Rule, it returns false so we can add to the multiplier as usual
-            if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-                AddPct(multiplier, (*i)->GetAmount());
-        }
-    }
-    // Add the highest of the Same Effect Stack Rule SpellGroups to the multiplier
-    for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
-        AddPct(multiplier, itr->second);
+int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
+{
+    return GetAuraModifierTotals(auratype).maxPositive;
+}
 
-    return multiplier;
+int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
+{
+    return GetAuraModifierTotals(auratype).maxNegative;
+}
+
+int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 miscMask) const
+{
+    return GetAuraModifierTotalsByMiscMask(auratype, miscMask).total;
+}
+
+float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 miscMask) const
+{
+    return GetAuraModifierTotalsByMiscMask(auratype, miscMask).multiplier;
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 miscMask, const AuraEffect* except) const
 {
+    if (!except)
+        return GetAuraModifierTotalsByMiscMask(auratype, miscMask).maxPositive;
+
     int32 modifier = 0;
 
     AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
@@ -4621,82 +4700,27 @@ int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 miscM
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 miscMask) const
 {
-    int32 modifier = 0;
-
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        if ((*i)->GetMiscValue()& miscMask && (*i)->GetAmount() < modifier)
-            modifier = (*i)->GetAmount();
-    }
-
-    return modifier;
+    return GetAuraModifierTotalsByMiscMask(auratype, miscMask).maxNegative;
 }
 
 int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 miscValue) const
 {
-    std::map<SpellGroup, int32> SameEffectSpellGroup;
-    int32 modifier = 0;
-
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        if ((*i)->GetMiscValue() == miscValue)
-            if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-                modifier += (*i)->GetAmount();
-    }
-
-    for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
-        modifier += itr->second;
-
-    return modifier;
+    return GetAuraModifierTotalsByMiscValue(auratype, miscValue).total;
 }
 
 float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 miscValue) const
 {
-    std::map<SpellGroup, int32> SameEffectSpellGroup;
-    float multiplier = 1.0f;
-
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        if ((*i)->GetMiscValue() == miscValue)
-            if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-                AddPct(multiplier, (*i)->GetAmount());
-    }
-
-    for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
-        AddPct(multiplier, itr->second);
-
-    return multiplier;
+    return GetAuraModifierTotalsByMiscValue(auratype, miscValue).multiplier;
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 miscValue) const
 {
-    int32 modifier = 0;
-
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        if ((*i)->GetMiscValue() == miscValue && (*i)->GetAmount() > modifier)
-            modifier = (*i)->GetAmount();
-    }
-
-    return modifier;
+    return GetAuraModifierTotalsByMiscValue(auratype, miscValue).maxPositive;
 }
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 miscValue) const
 {
-    int32 modifier = 0;
-
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        if ((*i)->GetMiscValue() == miscValue && (*i)->GetAmount() < modifier)
-            modifier = (*i)->GetAmount();
-    }
-
-    return modifier;
+    return GetAuraModifierTotalsByMiscValue(auratype, miscValue).maxNegative;
 }
 
 int32 Unit::GetTotalAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const
@@ -14078,19 +14102,23 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
     ProcEventInfo eventInfo = ProcEventInfo(actor, actionTarget, target, procFlag, 0, 0, procExtra, NULL, &damageInfo, &healInfo);
 
     ProcTriggeredList procTriggered;
-    // Fill procTriggered list
-    for (AuraApplicationMap::const_iterator itr = GetAppliedAuras().begin(); itr!= GetAppliedAuras().end(); ++itr)
+    if (isVictim)
+        procExtra &= ~PROC_EX_INTERNAL_REQ_FAMILY;
+
+    // Fill procTriggered list, only auras with a matching proc flag can pass IsTriggeredAtSpellProcEvent
+    for (ProcAuraMap::const_iterator itr = m_procAuras.begin(); itr != m_procAuras.end(); ++itr)
     {
+        if (!(itr->second.first & procFlag))
+            continue;
         // Do not allow auras to proc from effect triggered by itself
         if (procAura && procAura->Id == itr->first)
             continue;
-        ProcTriggeredData triggerData(itr->second->GetBase());
+        AuraApplication* aurApp = itr->second.second;
+        ProcTriggeredData triggerData(aurApp->GetBase());
         // Defensive procs are active on absorbs (so absorption effects are not a hindrance)
         bool active = damage || (procExtra & PROC_EX_BLOCK && isVictim);
-        if (isVictim)
-            procExtra &= ~PROC_EX_INTERNAL_REQ_FAMILY;
 
-        SpellInfo const* spellProto = itr->second->GetBase()->GetSpellInfo();
+        SpellInfo const* spellProto = aurApp->GetBase()->GetSpellInfo();
 
         // only auras that has triggered spell should proc from fully absorbed damage
         if (procExtra & PROC_EX_ABSORB && isVictim)
@@ -14107,7 +14135,7 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
             continue;
 
         // AuraScript Hook
-        if (!triggerData.aura->CallScriptCheckProcHandlers(itr->second, eventInfo))
+        if (!triggerData.aura->CallScriptCheckProcHandlers(aurApp, eventInfo))
             continue;
 
         // Triggered spells not triggering additional spells
@@ -14116,9 +14144,9 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
 
         for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
         {
-            if (itr->second->HasEffect(i))
+            if (aurApp->HasEffect(i))
             {
-                AuraEffect* aurEff = itr->second->GetBase()->GetEffect(i);
+                AuraEffect* aurEff = aurApp->GetBase()->GetEffect(i);
                 // Skip this auras
                 if (isNonTriggerAura[aurEff->GetAuraType()])
                     continue;
@@ -991,6 +991,30 @@ struct SpellPeriodicAuraLogInfo
 
 uint32 createProcExtendMask(SpellNonMeleeDamage* damageInfo, SpellMissInfo missCondition);
 
+// Sums of the applied aura effects of one aura type, as returned by Unit::GetTotalAuraModifier and friends
+struct AuraModifierTotals
+{
+    AuraModifierTotals() : total(0), multiplier(1.0f), maxPositive(0), maxNegative(0) { }
+
+    int32 total;
+    float multiplier;
+    int32 maxPositive;
+    int32 maxNegative;
+};
+
+// Totals of one aura type kept by a unit until an effect of that type is applied, removed or changes amount
+struct AuraModifierCache
+{
+    AuraModifierCache() : valid(false) { }
+
+    bool valid;
+    AuraModifierTotals totals;
+    std::unordered_map<uint32, AuraModifierTotals> byMiscMask;
+    std::unordered_map<int32, AuraModifierTotals> byMiscValue;
+};
+
+typedef std::unordered_map<uint32 /*AuraType*/, AuraModifierCache> AuraModifierCacheMap;
+
 struct RedirectThreatInfo
 {
     RedirectThreatInfo() : _threatPct(0) { }
@@ -1267,6 +1291,8 @@ class Unit : public WorldObject
         typedef std::pair<AuraApplicationMap::const_iterator, AuraApplicationMap::const_iterator> AuraApplicationMapBounds;
         typedef std::pair<AuraApplicationMap::iterator, AuraApplicationMap::iterator> AuraApplicationMapBoundsNonConst;
 
+        typedef std::multimap<uint32 /*spellId*/, std::pair<uint32 /*procFlags*/, AuraApplication*> > ProcAuraMap;
+
         typedef std::multimap<AuraStateType,  AuraApplication*> AuraStateAurasMap;
         typedef std::pair<AuraStateAurasMap::const_iterator, AuraStateAurasMap::const_iterator> AuraStateAurasMapBounds;
 
@@ -1725,6 +1751,7 @@ class Unit : public WorldObject
         void _RemoveNoStackAurasDueToAura(Aura* aura);
         bool _IsNoStackAuraDueToAura(Aura* appliedAura, Aura* existingAura) const;
         void _RegisterAuraEffect(AuraEffect* aurEff, bool apply);
+        void _InvalidateAuraModifierTotals(AuraType auraType) { m_modAuraTotals.erase(auraType); }
 
         // m_ownedAuras container management
         AuraMap      & GetOwnedAuras()       { return m_ownedAuras; }
@@ -1824,6 +1851,10 @@ class Unit : public WorldObject
         int32 GetMaxPositiveAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const;
         int32 GetMaxNegativeAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const;
 
+        AuraModifierTotals const& GetAuraModifierTotals(AuraType auratype) const;
+        AuraModifierTotals const& GetAuraModifierTotalsByMiscMask(AuraType auratype, uint32 misc_mask) const;
+        AuraModifierTotals const& GetAuraModifierTotalsByMiscValue(AuraType auratype, int32 misc_value) const;
+
         float GetResistanceBuffMods(SpellSchools school, bool positive) const;
         void SetResistanceBuffMods(SpellSchools school, bool positive, float val);
         void ApplyResistanceBuffModsMod(SpellSchools school, bool positive, float val, bool apply);
@@ -2213,9 +2244,11 @@ class Unit : public WorldObject
         uint32 m_removedAurasCount;
 
         AuraEffectList m_modAuras[TOTAL_AURAS];
+        mutable AuraModifierCacheMap m_modAuraTotals;     // lazily filled, only for types with applied effects
         AuraList m_scAuras;                        // cast singlecast auras
         AuraApplicationList m_interruptableAuras;  // auras which have interrupt mask applied on unit
         AuraStateAurasMap m_auraStateAuras;        // Used for improve performance of aura state checks on aura apply/remove
+        ProcAuraMap m_procAuras;                   // applied auras that can proc in ProcDamageAndSpellFor, in m_appliedAuras order
         uint32 m_interruptMask;
 
         float m_auraModifiersGroup[UNIT_MOD_END][MODIFIER_TYPE_END];
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CellPositionIndex.h"
+#include "Object.h"
+
+CellPositionIndex::~CellPositionIndex()
+{
+    // objects still linked when the cell goes away must not keep a dangling index
+    for (std::vector<PhaseBucket>::const_iterator bucket = _buckets.begin(); bucket != _buckets.end(); ++bucket)
+        for (std::vector<WorldObject*>::const_iterator itr = bucket->objects.begin(); itr != bucket->objects.end(); ++itr)
+            (*itr)->m_positionIndex = NULL;
+}
+
+void CellPositionIndex::Insert(WorldObject* obj)
+{
+    ASSERT(!obj->m_positionIndex);
+
+    uint32 phaseMask = obj->GetPhaseMask();
+    uint32 bucketIndex = 0;
+    while (bucketIndex < _buckets.size() && _buckets[bucketIndex].phaseMask != phaseMask)
+        ++bucketIndex;
+    if (bucketIndex == _buckets.size())
+        _buckets.push_back(PhaseBucket(phaseMask));
+
+    PhaseBucket& bucket = _buckets[bucketIndex];
+    obj->m_positionIndex = this;
+    obj->m_positionIndexBucket = bucketIndex;
+    obj->m_positionIndexSlot = bucket.Size();
+
+    bucket.x.push_back(obj->GetPositionX());
+    bucket.y.push_back(obj->GetPositionY());
+    bucket.z.push_back(obj->GetPositionZ());
+    bucket.size.push_back(obj->GetObjectSize());
+    bucket.objects.push_back(obj);
+}
+
+void CellPositionIndex::Remove(WorldObject* obj)
+{
+    ASSERT(obj->m_positionIndex == this);
+
+    PhaseBucket& bucket = _buckets[obj->m_positionIndexBucket];
+    uint32 slot = obj->m_positionIndexSlot;
+    uint32 last = bucket.Size() - 1;
+    if (slot != last)
+    {
+        bucket.x[slot] = bucket.x[last];
+        bucket.y[slot] = bucket.y[last];
+        bucket.z[slot] = bucket.z[last];
+        bucket.size[slot] = bucket.size[last];
+        bucket.objects[slot] = bucket.objects[last];
+        bucket.objects[slot]->m_positionIndexSlot = slot;
+    }
+
+    bucket.x.pop_back();
+    bucket.y.pop_back();
+    bucket.z.pop_back();
+    bucket.size.pop_back();
+    bucket.objects.pop_back();
+
+    obj->m_positionIndex = NULL;
+}
+
+void CellPositionIndex::Update(WorldObject* obj)
+{
+    PhaseBucket& bucket = _buckets[obj->m_positionIndexBucket];
+
+    // moving to another phase moves the object to that phase's bucket
+    if (bucket.phaseMask != obj->GetPhaseMask())
+    {
+        Remove(obj);
+        Insert(obj);
+        return;
+    }
+
+    uint32 slot = obj->m_positionIndexSlot;
+    bucket.x[slot] = obj->GetPositionX();
+    bucket.y[slot] = obj->GetPositionY();
+    bucket.z[slot] = obj->GetPositionZ();
+    bucket.size[slot] = obj->GetObjectSize();
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_CELLPOSITIONINDEX_H
+#define TRINITY_CELLPOSITIONINDEX_H
+
+#include "Define.h"
+#include <vector>
+
+class WorldObject;
+
+/*
+  @class CellPositionIndex
+  Packed copy of the position and object size of the objects linked in a
+  grid cell, bucketed by phase mask and stored as one array per field.
+  Range tests run over these arrays before the object itself is touched,
+  instead of chasing the cell's intrusive reference list, and phase bound
+  scans skip the buckets whose mask shares no bit with theirs.
+
+  Objects know their bucket and slot, so removal is a swap with the last
+  entry and the copy is refreshed from Map::PlayerRelocation and
+  SetPhaseMask.  Buckets stay allocated while the cell exists, a cell only
+  ever sees the few phases used around it.
+*/
+class CellPositionIndex
+{
+    public:
+        CellPositionIndex() { }
+        ~CellPositionIndex();
+
+        void Insert(WorldObject* obj);
+        void Remove(WorldObject* obj);
+        void Update(WorldObject* obj);
+
+        // Calls func for objects sharing a phase with phaseMask whose 2d distance to (x, y) is within range, same test as GetExactDist2dSq
+        template<class FUNC> void VisitInRange2d(float x, float y, float range, uint32 phaseMask, FUNC& func) const
+        {
+            float rangeSq = range * range;
+            for (std::vector<PhaseBucket>::const_iterator bucket = _buckets.begin(); bucket != _buckets.end(); ++bucket)
+            {
+                if (!bucket->InPhase(phaseMask))
+                    continue;
+
+                uint32 count = bucket->Size();
+                for (uint32 i = 0; i < count; ++i)
+                {
+                    float dx = bucket->x[i] - x;
+                    float dy = bucket->y[i] - y;
+                    if (dx * dx + dy * dy <= rangeSq)
+                        func(bucket->objects[i]);
+                }
+            }
+        }
+
+        // Calls func for objects of any phase within range of (x, y, z) including their object size, same test as IsWithinDist3d
+        template<class FUNC> void VisitInRange3d(float x, float y, float z, float range, FUNC& func) const
+        {
+            for (std::vector<PhaseBucket>::const_iterator bucket = _buckets.begin(); bucket != _buckets.end(); ++bucket)
+            {
+                uint32 count = bucket->Size();
+                for (uint32 i = 0; i < count; ++i)
+                {
+                    float dx = bucket->x[i] - x;
+                    float dy = bucket->y[i] - y;
+                    float dz = bucket->z[i] - z;
+                    float maxDist = range + bucket->size[i];
+                    if (dx * dx + dy * dy + dz * dz < maxDist * maxDist)
+                        func(bucket->objects[i]);
+                }
+            }
+        }
+
+        // Calls func for every object sharing a phase with phaseMask
+        template<class FUNC> void VisitInPhase(uint32 phaseMask, FUNC& func) const
+        {
+            for (std::vector<PhaseBucket>::const_iterator bucket = _buckets.begin(); bucket != _buckets.end(); ++bucket)
+                if (bucket->InPhase(phaseMask))
+                    for (uint32 i = 0; i < bucket->Size(); ++i)
+                        func(bucket->objects[i]);
+        }
+
+    private:
+        struct PhaseBucket
+        {
+            explicit PhaseBucket(uint32 phase) : phaseMask(phase) { }
+
+            uint32 Size() const { return uint32(objects.size()); }
+            // same test as WorldObject::InSamePhase, a bucket holds one exact mask but matches every overlapping one
+            bool InPhase(uint32 phase) const { return (phaseMask & phase) != 0; }
+
+            uint32 phaseMask;
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> z;
+            std::vector<float> size;
+            std::vector<WorldObject*> objects;
+        };
+
+        CellPositionIndex(CellPositionIndex const&);
+        CellPositionIndex& operator=(CellPositionIndex const&);
+
+        std::vector<PhaseBucket> _buckets;
+};
+
+#endif
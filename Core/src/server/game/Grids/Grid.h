@@ -33,6 +33,7 @@
 #include "Define.h"
 #include "TypeContainer.h"
 #include "TypeContainerVisitor.h"
+#include "CellPositionIndex.h"
 
 // forward declaration
 template<class A, class T, class O> class GridLoader;
@@ -62,6 +63,17 @@ class Grid
             ASSERT(obj->IsInGrid());
         }
 
+        /** the object of interest enters the grid, it is also tracked in the packed
+        position index. Map refreshes the copy when it relocates the object and
+        drops it before unlinking the object from the grid.
+         */
+        void AddWorldObject(ACTIVE_OBJECT *obj)
+        {
+            i_objects.template insert<ACTIVE_OBJECT>(obj);
+            ASSERT(obj->IsInGrid());
+            i_activeObjectIndex.Insert(obj);
+        }
+
         /** an object of interested exits the grid
          */
         //Actually an unlink is enough, no need to go through the container
@@ -101,6 +113,10 @@ class Grid
         /** Returns the number of object within the grid.
          */
         //unsigned int ActiveObjectsInGrid(void) const { return i_objects.template Count<ACTIVE_OBJECT>(); }
+        /** Returns the packed positions of the objects of interest within the grid.
+         */
+        CellPositionIndex const& GetActiveObjectIndex() const { return i_activeObjectIndex; }
+
         template<class T>
         uint32 GetWorldObjectCountInGrid() const
         {
@@ -137,6 +153,7 @@ class Grid
 
         TypeMapContainer<GRID_OBJECT_TYPES> i_container;
         TypeMapContainer<WORLD_OBJECT_TYPES> i_objects;
+        CellPositionIndex i_activeObjectIndex;
         //typedef std::set<void*> ActiveGridObjects;
         //ActiveGridObjects m_activeGridObjects;
 };
@@ -19,6 +19,7 @@
 #include "GridStates.h"
 #include "GridNotifiers.h"
 #include "Log.h"
+#include "MapManager.h"
 
 void InvalidState::Update(Map&, NGridType&, GridInfo&, uint32) const
 { }
@@ -42,10 +43,12 @@ void ActiveState::Update(Map& map, NGridType& grid, GridInfo&  info, uint32 diff
     }
 }
 
-void IdleState::Update(Map& map, NGridType& grid, GridInfo&, uint32) const
+void IdleState::Update(Map& map, NGridType& grid, GridInfo& info, uint32) const
 {
     map.ResetGridExpiry(grid);
     grid.SetGridState(GRID_STATE_REMOVAL);
+    if (!info.getUnloadLock())
+        sMapMgr->GetGridResidency()->OnGridIdle(map, grid.getX(), grid.getY());
     TC_LOG_DEBUG("maps", "Grid[%u, %u] on map %u moved to REMOVAL state", grid.getX(), grid.getY(), map.GetId());
 }
 
@@ -54,7 +57,13 @@ void RemovalState::Update(Map& map, NGridType& grid, GridInfo& info, uint32 diff
     if (!info.getUnloadLock())
     {
         info.UpdateTimeTracker(diff);
-        if (info.getTimeTracker().Passed() && !map.UnloadGrid(grid, false))
+        if (!info.getTimeTracker().Passed())
+            return;
+
+        // kept loaded within the idle grid budget, checked again after the usual delay
+        if (sMapMgr->GetGridResidency()->Retain(map, grid.getX(), grid.getY()))
+            map.ResetGridExpiry(grid);
+        else if (!map.UnloadGrid(grid, false))
         {
             TC_LOG_DEBUG("maps", "Grid[%u, %u] for map %u differed unloading due to players or active objects nearby", grid.getX(), grid.getY(), map.GetId());
             map.ResetGridExpiry(grid);
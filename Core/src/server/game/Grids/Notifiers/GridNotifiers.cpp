@@ -28,19 +28,28 @@
 #include "CellImpl.h"
 #include "SpellInfo.h"
 
+#include <algorithm>
+#include <iterator>
+
 using namespace Trinity;
 
 void VisibleNotifier::SendToSelf()
 {
-    // at this moment i_clientGUIDs have guids that not iterate at grid level checks
+    // only the guids that were at client before the pass and not met in any visited cell are left
+    std::sort(i_visited.begin(), i_visited.end());
+    GuidVector vis_guids;
+    std::set_difference(i_clientGUIDs.begin(), i_clientGUIDs.end(), i_visited.begin(), i_visited.end(), std::back_inserter(vis_guids));
+
+    // at this moment vis_guids have guids that not iterate at grid level checks
     // but exist one case when this possible and object not out of range: transports
     if (Transport* transport = i_player.GetTransport())
     {
         for (Transport::PassengerSet::const_iterator itr = transport->GetPassengers().begin(); itr != transport->GetPassengers().end(); ++itr)
         {
-            if (vis_guids.find((*itr)->GetGUID()) != vis_guids.end())
+            GuidVector::iterator passenger = std::lower_bound(vis_guids.begin(), vis_guids.end(), (*itr)->GetGUID());
+            if (passenger != vis_guids.end() && *passenger == (*itr)->GetGUID())
             {
-                vis_guids.erase((*itr)->GetGUID());
+                vis_guids.erase(passenger);
 
                 switch ((*itr)->GetTypeId())
                 {
@@ -65,7 +74,7 @@ void VisibleNotifier::SendToSelf()
         }
     }
 
-    for (GuidSet::const_iterator it = vis_guids.begin(); it != vis_guids.end(); ++it)
+    for (GuidVector::const_iterator it = vis_guids.begin(); it != vis_guids.end(); ++it)
     {
         i_player.m_clientGUIDs.erase(*it);
         i_data.AddOutOfRangeGUID(*it);
@@ -81,11 +90,17 @@ void VisibleNotifier::SendToSelf()
     if (!i_data.HasData())
         return;
 
+    if (i_player.GetMap()->IsDeferringVisibility())
+    {
+        i_player.DeferVisibility(i_data, i_visibleNow);
+        return;
+    }
+
     WorldPacket packet;
     i_data.BuildPacket(&packet);
     i_player.GetSession()->SendPacket(&packet);
 
-    for (std::set<Unit*>::const_iterator it = i_visibleNow.begin(); it != i_visibleNow.end(); ++it)
+    for (std::vector<Unit*>::const_iterator it = i_visibleNow.begin(); it != i_visibleNow.end(); ++it)
         i_player.SendInitialVisiblePackets(*it);
 }
 
@@ -139,21 +154,42 @@ inline void CreatureUnitRelocationWorker(Creature* c, Unit* u)
             c->AI()->MoveInLineOfSight_Safe(u);
 }
 
-void PlayerRelocationNotifier::Visit(PlayerMapType &m)
+void VisibleNotifier::operator()(WorldObject* object)
 {
-    for (PlayerMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        Player* player = iter->GetSource();
+    Player* player = object->ToPlayer();
+    i_visited.push_back(player->GetGUID());
+    i_player.UpdateVisibilityOf(player, i_data, i_visibleNow);
+}
 
-        vis_guids.erase(player->GetGUID());
+template<class NOTIFIER>
+inline void VisitPlayersInPhaseOf(NOTIFIER& notifier, WorldObject const& viewPoint, float radius)
+{
+    if (viewPoint.IsInWorld())
+        viewPoint.GetMap()->VisitPlayersInPhase(viewPoint.GetPositionX(), viewPoint.GetPositionY(), radius, notifier.i_player.GetPhaseMask(), notifier);
+}
 
-        i_player.UpdateVisibilityOf(player, i_data, i_visibleNow);
+void VisibleNotifier::VisitPlayers(WorldObject const& viewPoint, float radius)
+{
+    VisitPlayersInPhaseOf(*this, viewPoint, radius);
+}
 
-        if (player->m_seer->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
-            continue;
+void PlayerRelocationNotifier::operator()(WorldObject* object)
+{
+    Player* player = object->ToPlayer();
 
-        player->UpdateVisibilityOf(&i_player);
-    }
+    i_visited.push_back(player->GetGUID());
+
+    i_player.UpdateVisibilityOf(player, i_data, i_visibleNow);
+
+    if (player->m_seer->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
+        return;
+
+    player->UpdateVisibilityOf(&i_player);
+}
+
+void PlayerRelocationNotifier::VisitPlayers(WorldObject const& viewPoint, float radius)
+{
+    VisitPlayersInPhaseOf(*this, viewPoint, radius);
 }
 
 void PlayerRelocationNotifier::Visit(CreatureMapType &m)
@@ -164,7 +200,7 @@ void PlayerRelocationNotifier::Visit(CreatureMapType &m)
     {
         Creature* c = iter->GetSource();
 
-        vis_guids.erase(c->GetGUID());
+        i_visited.push_back(c->GetGUID());
 
         i_player.UpdateVisibilityOf(c, i_data, i_visibleNow);
 
@@ -242,6 +278,7 @@ void DelayedUnitRelocation::Visit(PlayerMapType &m)
 
         cell2.Visit(pair2, c2world_relocation, i_map, *viewPoint, i_radius);
         cell2.Visit(pair2, c2grid_relocation, i_map, *viewPoint, i_radius);
+        relocate.VisitPlayers(*viewPoint, i_radius + viewPoint->GetObjectSize());
 
         relocate.SendToSelf();
     }
@@ -258,29 +295,32 @@ void AIRelocationNotifier::Visit(CreatureMapType &m)
     }
 }
 
-void MessageDistDeliverer::Visit(PlayerMapType &m)
+void MessageDistDeliverer::Deliver(float radius)
 {
-    for (PlayerMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        Player* target = iter->GetSource();
-        if (!target->InSamePhase(i_phaseMask))
-            continue;
+    if (!i_source->IsInWorld())
+        return;
 
-        if (target->GetExactDist2dSq(i_source) > i_distSq)
-            continue;
+    Map* map = i_source->GetMap();
+    map->VisitPlayersInRange2d(i_source->GetPositionX(), i_source->GetPositionY(), radius, i_phaseMask, *this);
+    map->VisitWorld(i_source->GetPositionX(), i_source->GetPositionY(), radius, *this);
+}
 
-        // Send packet to all who are sharing the player's vision
-        if (target->HasSharedVision())
-        {
-            SharedVisionList::const_iterator i = target->GetSharedVisionList().begin();
-            for (; i != target->GetSharedVisionList().end(); ++i)
-                if ((*i)->m_seer == target)
-                    SendPacket(*i);
-        }
+// Distance and phase, any bit shared with the source, are already checked by the packed index scan
+void MessageDistDeliverer::operator()(WorldObject* object)
+{
+    Player* target = object->ToPlayer();
 
-        if (target->m_seer == target || target->GetVehicle())
-            SendPacket(target);
+    // Send packet to all who are sharing the player's vision
+    if (target->HasSharedVision())
+    {
+        SharedVisionList::const_iterator i = target->GetSharedVisionList().begin();
+        for (; i != target->GetSharedVisionList().end(); ++i)
+            if ((*i)->m_seer == target)
+                SendPacket(*i);
     }
+
+    if (target->m_seer == target || target->GetVehicle())
+        SendPacket(target);
 }
 
 void MessageDistDeliverer::Visit(CreatureMapType &m)
@@ -42,11 +42,19 @@ namespace Trinity
     {
         Player &i_player;
         UpdateData i_data;
-        std::set<Unit*> i_visibleNow;
-        GuidSet vis_guids;
+        std::vector<Unit*> i_visibleNow;
+        GuidVector i_clientGUIDs;   // sorted copy of m_clientGUIDs when the pass started
+        GuidVector i_visited;       // objects met in the visited cells, the others get out of range in SendToSelf
 
-        VisibleNotifier(Player &player) : i_player(player), vis_guids(player.m_clientGUIDs) { }
+        VisibleNotifier(Player &player) : i_player(player), i_clientGUIDs(player.m_clientGUIDs.begin(), player.m_clientGUIDs.end())
+        {
+            i_visited.reserve(i_clientGUIDs.size());
+        }
         template<class T> void Visit(GridRefManager<T> &m);
+        // Players of other phases can never be seen, so players are only visited from the player's phase bucket
+        void Visit(PlayerMapType &) { }
+        void operator()(WorldObject* object);
+        void VisitPlayers(WorldObject const& viewPoint, float radius);
         void SendToSelf(void);
     };
 
@@ -67,7 +75,8 @@ namespace Trinity
 
         template<class T> void Visit(GridRefManager<T> &m) { VisibleNotifier::Visit(m); }
         void Visit(CreatureMapType &);
-        void Visit(PlayerMapType &);
+        void operator()(WorldObject* object);
+        void VisitPlayers(WorldObject const& viewPoint, float radius);
     };
 
     struct CreatureRelocationNotifier
@@ -138,7 +147,10 @@ namespace Trinity
                     team = player->GetTeam();
         }
 
-        void Visit(PlayerMapType &m);
+        // Players come from the cells' packed position index, creatures and dynamic objects from the world containers
+        void Deliver(float radius);
+
+        void operator()(WorldObject* target);
         void Visit(CreatureMapType &m);
         void Visit(DynamicObjectMapType &m);
         template<class SKIP> void Visit(GridRefManager<SKIP> &) { }
@@ -230,6 +242,22 @@ namespace Trinity
         template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED> &) { }
     };
 
+    // Collects the objects found by Map::VisitPlayersInRange2d/3d that pass the check
+    template<class Check>
+    struct WorldObjectListInserter
+    {
+        std::list<WorldObject*> &i_objects;
+        Check& i_check;
+
+        WorldObjectListInserter(std::list<WorldObject*> &objects, Check & check) : i_objects(objects), i_check(check) { }
+
+        void operator()(WorldObject* obj)
+        {
+            if (i_check(obj))
+                i_objects.push_back(obj);
+        }
+    };
+
     template<class Do>
     struct WorldObjectWorker
     {
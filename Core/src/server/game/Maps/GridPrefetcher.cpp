@@ -0,0 +1,94 @@
+/*
+* Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+* Copyright (C) 2005-2009 MaNGOS <http://getmangos.com/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GridPrefetcher.h"
+#include "Map.h"
+
+class GridPrefetchRequest
+{
+    private:
+
+        Map& m_map;
+        int m_gx;
+        int m_gy;
+
+    public:
+
+        GridPrefetchRequest(Map& m, int gx, int gy)
+            : m_map(m), m_gx(gx), m_gy(gy)
+        {
+        }
+
+        void call()
+        {
+            m_map.PrepareGridMap(m_gx, m_gy);
+        }
+};
+
+void GridPrefetcher::activate(size_t num_threads)
+{
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        _workerThreads.push_back(std::thread(&GridPrefetcher::WorkerThread, this));
+    }
+}
+
+void GridPrefetcher::deactivate()
+{
+    _cancelationToken = true;
+
+    // requests still queued are dropped, maps delete the grids they were waiting for
+    _queue.Cancel();
+
+    for (auto& thread : _workerThreads)
+    {
+        thread.join();
+    }
+
+    _workerThreads.clear();
+}
+
+void GridPrefetcher::schedule_prefetch(Map& map, int gx, int gy)
+{
+    _queue.Push(new GridPrefetchRequest(map, gx, gy));
+}
+
+bool GridPrefetcher::activated()
+{
+    return _workerThreads.size() > 0;
+}
+
+void GridPrefetcher::WorkerThread()
+{
+    while (1)
+    {
+        GridPrefetchRequest* request = nullptr;
+
+        _queue.WaitAndPop(request);
+
+        if (_cancelationToken)
+        {
+            delete request;
+            return;
+        }
+
+        request->call();
+
+        delete request;
+    }
+}
@@ -0,0 +1,58 @@
+/*
+* Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+* Copyright (C) 2005-2009 MaNGOS <http://getmangos.com/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _GRID_PREFETCHER_H_INCLUDED
+#define _GRID_PREFETCHER_H_INCLUDED
+
+#include "Define.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ProducerConsumerQueue.h"
+
+class GridPrefetchRequest;
+class Map;
+
+// Prepares the terrain of grids that players are heading to on worker threads,
+// so the map update thread does not block on file reads when the grid is entered
+class GridPrefetcher
+{
+    public:
+
+        GridPrefetcher() : _cancelationToken(false) {}
+        ~GridPrefetcher() { };
+
+        void schedule_prefetch(Map& map, int gx, int gy);
+
+        void activate(size_t num_threads);
+
+        void deactivate();
+
+        bool activated();
+
+    private:
+
+        ProducerConsumerQueue<GridPrefetchRequest*> _queue;
+
+        std::vector<std::thread> _workerThreads;
+        std::atomic<bool> _cancelationToken;
+
+        void WorkerThread();
+};
+
+#endif //_GRID_PREFETCHER_H_INCLUDED
@@ -0,0 +1,152 @@
+/*
+* Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GridResidency.h"
+#include "Config.h"
+#include "DBCStores.h"
+#include "GridDefines.h"
+#include "Log.h"
+#include "MapManager.h"
+#include "Util.h"
+#include "World.h"
+
+uint64 GridResidency::MakeKey(Map const& map, uint32 gx, uint32 gy)
+{
+    return (uint64(map.GetInstanceId()) << 32) | (map.GetId() << 12) | (gx << 6) | gy;
+}
+
+void GridResidency::Initialize()
+{
+    _maxIdleGrids = sWorld->getIntConfig(CONFIG_GRID_RESIDENCY_MAX_IDLE_GRIDS);
+    _statsTimer.SetInterval(sWorld->getIntConfig(CONFIG_GRID_RESIDENCY_STATS_INTERVAL) * IN_MILLISECONDS);
+}
+
+void GridResidency::LoadHotGrids()
+{
+    // "mapId:gridX:gridY" entries separated by spaces, grid coordinates as shown by .gps
+    Tokenizer tokens(sConfigMgr->GetStringDefault("GridResidency.HotGrids", ""), ' ');
+    for (Tokenizer::const_iterator itr = tokens.begin(); itr != tokens.end(); ++itr)
+    {
+        uint32 mapId, gx, gy;
+        if (sscanf(*itr, "%u:%u:%u", &mapId, &gx, &gy) != 3)
+        {
+            TC_LOG_ERROR("server.loading", "GridResidency.HotGrids: '%s' is not a mapId:gridX:gridY entry, skipped.", *itr);
+            continue;
+        }
+
+        MapEntry const* entry = sMapStore.LookupEntry(mapId);
+        if (!entry || entry->Instanceable() || gx >= MAX_NUMBER_OF_GRIDS || gy >= MAX_NUMBER_OF_GRIDS)
+        {
+            TC_LOG_ERROR("server.loading", "GridResidency.HotGrids: grid [%u, %u] on map %u is not a grid of a non instanced map, skipped.", gx, gy, mapId);
+            continue;
+        }
+
+        sMapMgr->CreateBaseMap(mapId)->PinGrid(GridCoord(gx, gy));
+        ++_pinned;
+    }
+
+    TC_LOG_INFO("server.loading", ">> Loaded %u hot grids", _pinned);
+}
+
+void GridResidency::Update(uint32 diff)
+{
+    if (!_statsTimer.GetInterval())
+        return;
+
+    _statsTimer.Update(diff);
+    if (!_statsTimer.Passed())
+        return;
+
+    std::lock_guard<std::mutex> lock(_lock);
+    TC_LOG_INFO("maps", "Grid residency: %u grids loaded (%u hot, %u idle), %.2f loads/sec, " UI64FMTD " loads, " UI64FMTD " unloads, " UI64FMTD " evictions",
+        _resident, _pinned, uint32(_idleGrids.size() + _evictingGrids.size()), float(_loads - _lastLoads) * IN_MILLISECONDS / _statsTimer.GetCurrent(), _loads, _unloads, _evictions);
+
+    _lastLoads = _loads;
+    _statsTimer.SetCurrent(0);
+}
+
+void GridResidency::OnGridLoaded(Map const& /*map*/, uint32 /*gx*/, uint32 /*gy*/)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    ++_loads;
+    ++_resident;
+}
+
+void GridResidency::OnGridUnloaded(Map const& map, uint32 gx, uint32 gy)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    ++_unloads;
+    --_resident;
+
+    IdleGridMap::iterator itr = _idleGridsByKey.find(MakeKey(map, gx, gy));
+    if (itr == _idleGridsByKey.end())
+        return;
+
+    if (itr->second->evicting)
+        ++_evictions;
+    EraseIdleGrid(itr);
+}
+
+void GridResidency::OnGridIdle(Map const& map, uint32 gx, uint32 gy)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    uint64 key = MakeKey(map, gx, gy);
+    IdleGridMap::iterator itr = _idleGridsByKey.find(key);
+    if (itr != _idleGridsByKey.end())
+        EraseIdleGrid(itr);
+
+    _idleGridsByKey[key] = _idleGrids.insert(_idleGrids.end(), IdleGrid(key));
+}
+
+void GridResidency::OnGridActive(Map const& map, uint32 gx, uint32 gy)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    IdleGridMap::iterator itr = _idleGridsByKey.find(MakeKey(map, gx, gy));
+    if (itr == _idleGridsByKey.end())
+        return;
+
+    EraseIdleGrid(itr);
+}
+
+bool GridResidency::Retain(Map const& map, uint32 gx, uint32 gy)
+{
+    if (!_maxIdleGrids)
+        return false;
+
+    std::lock_guard<std::mutex> lock(_lock);
+    IdleGridMap::iterator itr = _idleGridsByKey.find(MakeKey(map, gx, gy));
+    if (itr == _idleGridsByKey.end())
+        return false;
+
+    // the least recently used grids beyond the budget move to the eviction list, each grid moves at most once
+    while (_idleGrids.size() > _maxIdleGrids)
+    {
+        _idleGrids.front().evicting = true;
+        _evictingGrids.splice(_evictingGrids.end(), _idleGrids, _idleGrids.begin());
+    }
+
+    return !itr->second->evicting;
+}
+
+void GridResidency::EraseIdleGrid(IdleGridMap::iterator itr)
+{
+    if (itr->second->evicting)
+        _evictingGrids.erase(itr->second);
+    else
+        _idleGrids.erase(itr->second);
+    _idleGridsByKey.erase(itr);
+}
@@ -0,0 +1,85 @@
+/*
+* Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _GRID_RESIDENCY_H_INCLUDED
+#define _GRID_RESIDENCY_H_INCLUDED
+
+#include "Define.h"
+#include "Timer.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+class Map;
+
+// Keeps track of the grids that are loaded across all maps.
+// Hot grids from the config are loaded at startup and never unloaded. Grids
+// that ran out of their clean up delay stay loaded while the number of idle
+// grids is within the budget, beyond it the least recently used ones are
+// marked for eviction and unload on their next check.
+class GridResidency
+{
+    public:
+
+        GridResidency() : _maxIdleGrids(0), _loads(0), _unloads(0), _evictions(0), _resident(0), _pinned(0), _lastLoads(0) { }
+        ~GridResidency() { }
+
+        void Initialize();
+        void LoadHotGrids();
+        void Update(uint32 diff);
+
+        // Called from the map update threads
+        void OnGridLoaded(Map const& map, uint32 gx, uint32 gy);
+        void OnGridUnloaded(Map const& map, uint32 gx, uint32 gy);
+        void OnGridIdle(Map const& map, uint32 gx, uint32 gy);
+        void OnGridActive(Map const& map, uint32 gx, uint32 gy);
+
+        // Returns true if an idle grid past its clean up delay should stay loaded
+        bool Retain(Map const& map, uint32 gx, uint32 gy);
+
+    private:
+
+        struct IdleGrid
+        {
+            IdleGrid(uint64 k) : key(k), evicting(false) { }
+
+            uint64 key;
+            bool evicting;
+        };
+
+        typedef std::list<IdleGrid> IdleGridList;
+        typedef std::unordered_map<uint64, IdleGridList::iterator> IdleGridMap;
+
+        static uint64 MakeKey(Map const& map, uint32 gx, uint32 gy);
+        void EraseIdleGrid(IdleGridMap::iterator itr);
+
+        std::mutex _lock;
+        uint32 _maxIdleGrids;
+        IdleGridList _idleGrids;        // least recently used first, never more than _maxIdleGrids after Retain
+        IdleGridList _evictingGrids;    // moved out of _idleGrids over the budget, unloaded on their next check
+        IdleGridMap _idleGridsByKey;    // entries of both lists
+
+        IntervalTimer _statsTimer;
+        uint64 _loads;
+        uint64 _unloads;
+        uint64 _evictions;
+        uint32 _resident;
+        uint32 _pinned;
+        uint64 _lastLoads;
+};
+
+#endif //_GRID_RESIDENCY_H_INCLUDED
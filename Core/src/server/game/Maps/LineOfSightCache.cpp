@@ -0,0 +1,129 @@
+/*
+* Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LineOfSightCache.h"
+#include "Timer.h"
+#include <G3D/AABox.h>
+#include <algorithm>
+#include <cmath>
+
+// Expired entries are only dropped when the cache grows past this
+#define LOS_CACHE_MAX_ENTRIES   8192
+
+bool LineOfSightCache::Key::operator==(Key const& right) const
+{
+    return from[0] == right.from[0] && from[1] == right.from[1] && from[2] == right.from[2]
+        && to[0] == right.to[0] && to[1] == right.to[1] && to[2] == right.to[2]
+        && phaseMask == right.phaseMask;
+}
+
+size_t LineOfSightCache::KeyHash::operator()(Key const& key) const
+{
+    size_t hash = key.phaseMask;
+    for (uint8 i = 0; i < 3; ++i)
+    {
+        hash = hash * 31 + uint32(key.from[i]);
+        hash = hash * 31 + uint32(key.to[i]);
+    }
+    return hash;
+}
+
+void LineOfSightCache::Initialize(float gridSize, uint32 ttl)
+{
+    _gridSize = gridSize > 0.0f ? gridSize : 0.1f;
+    _ttl = ttl;
+    _entries.clear();
+}
+
+LineOfSightCache::Key LineOfSightCache::MakeKey(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phaseMask) const
+{
+    Key key;
+    key.from[0] = int32(std::floor(x1 / _gridSize));
+    key.from[1] = int32(std::floor(y1 / _gridSize));
+    key.from[2] = int32(std::floor(z1 / _gridSize));
+    key.to[0] = int32(std::floor(x2 / _gridSize));
+    key.to[1] = int32(std::floor(y2 / _gridSize));
+    key.to[2] = int32(std::floor(z2 / _gridSize));
+    key.phaseMask = phaseMask;
+    return key;
+}
+
+bool LineOfSightCache::Lookup(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phaseMask, bool& inSight)
+{
+    EntryMap::const_iterator itr = _entries.find(MakeKey(x1, y1, z1, x2, y2, z2, phaseMask));
+    if (itr == _entries.end() || getMSTimeDiff(itr->second.storeTime, getMSTime()) >= _ttl)
+    {
+        ++_misses;
+        return false;
+    }
+
+    ++_hits;
+    inSight = itr->second.inSight;
+    return true;
+}
+
+void LineOfSightCache::Invalidate(G3D::AABox const& bounds)
+{
+    if (_entries.empty())
+        return;
+
+    // a stored segment lies within the box spanned by the grid cells of its ends
+    int32 low[3];
+    int32 high[3];
+    for (uint8 i = 0; i < 3; ++i)
+    {
+        low[i] = int32(std::floor(bounds.low()[i] / _gridSize));
+        high[i] = int32(std::floor(bounds.high()[i] / _gridSize));
+    }
+
+    for (EntryMap::iterator itr = _entries.begin(); itr != _entries.end();)
+    {
+        Key const& key = itr->first;
+        bool overlaps = true;
+        for (uint8 i = 0; i < 3 && overlaps; ++i)
+            overlaps = std::min(key.from[i], key.to[i]) <= high[i] && std::max(key.from[i], key.to[i]) >= low[i];
+
+        if (overlaps)
+            itr = _entries.erase(itr);
+        else
+            ++itr;
+    }
+}
+
+void LineOfSightCache::Store(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phaseMask, bool inSight, uint32 traceTimeUs)
+{
+    uint32 now = getMSTime();
+    _traceTimeUs += traceTimeUs;
+
+    if (_entries.size() >= LOS_CACHE_MAX_ENTRIES)
+    {
+        for (EntryMap::iterator itr = _entries.begin(); itr != _entries.end();)
+        {
+            if (getMSTimeDiff(itr->second.storeTime, now) >= _ttl)
+                itr = _entries.erase(itr);
+            else
+                ++itr;
+        }
+
+        if (_entries.size() >= LOS_CACHE_MAX_ENTRIES)
+            _entries.clear();
+    }
+
+    Entry& entry = _entries[MakeKey(x1, y1, z1, x2, y2, z2, phaseMask)];
+    entry.storeTime = now;
+    entry.inSight = inSight;
+}
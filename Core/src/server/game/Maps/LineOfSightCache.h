@@ -0,0 +1,89 @@
+/*
+* Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _LINE_OF_SIGHT_CACHE_H_INCLUDED
+#define _LINE_OF_SIGHT_CACHE_H_INCLUDED
+
+#include "Define.h"
+#include <unordered_map>
+
+namespace G3D
+{
+    class AABox;
+}
+
+// Recent line of sight results of one map. Both ends of a segment are snapped
+// to a grid of GridSize yards, so queries between nearly the same points share
+// one trace. Results live for TTL ms, a gameobject model that is added, removed
+// or moved drops the results whose segment may pass through its bounds.
+class LineOfSightCache
+{
+    public:
+
+        LineOfSightCache() : _gridSize(0.0f), _ttl(0), _hits(0), _misses(0), _traceTimeUs(0) { }
+
+        void Initialize(float gridSize, uint32 ttl);
+        bool IsEnabled() const { return _ttl != 0; }
+
+        // Returns true and sets inSight if a live result for the snapped segment is stored
+        bool Lookup(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phaseMask, bool& inSight);
+        void Store(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phaseMask, bool inSight, uint32 traceTimeUs);
+        // Drops the results whose segment may pass through bounds
+        void Invalidate(G3D::AABox const& bounds);
+        void Clear() { _entries.clear(); }
+
+        uint64 GetHits() const { return _hits; }
+        uint64 GetMisses() const { return _misses; }
+        uint64 GetTraceTimeUs() const { return _traceTimeUs; }     // spent tracing the misses
+        uint32 GetSize() const { return uint32(_entries.size()); }
+
+    private:
+
+        struct Key
+        {
+            int32 from[3];
+            int32 to[3];
+            uint32 phaseMask;
+
+            bool operator==(Key const& right) const;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(Key const& key) const;
+        };
+
+        struct Entry
+        {
+            uint32 storeTime;
+            bool inSight;
+        };
+
+        typedef std::unordered_map<Key, Entry, KeyHash> EntryMap;
+
+        Key MakeKey(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phaseMask) const;
+
+        float _gridSize;
+        uint32 _ttl;
+        EntryMap _entries;
+
+        uint64 _hits;
+        uint64 _misses;
+        uint64 _traceTimeUs;
+};
+
+#endif //_LINE_OF_SIGHT_CACHE_H_INCLUDED
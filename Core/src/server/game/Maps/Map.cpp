@@ -35,9 +35,11 @@
 #include "Transport.h"
 #include "Vehicle.h"
 #include "VMapFactory.h"
+#include "MapTree.h"
 #ifdef ELUNA
 #include "LuaEngine.h"
 #endif
+#include <chrono>
 
 u_map_magic MapMagic        = { {'M','A','P','S'} };
 u_map_magic MapVersionMagic = { {'v','1','.','3'} };
@@ -73,7 +75,8 @@ Map::~Map()
     if (!m_scriptSchedule.empty())
         sScriptMgr->DecreaseScheduledScriptCount(m_scriptSchedule.size());
 
-    MMAP::MMapFactory::createOrGetMMapManager()->unloadMapInstance(GetId(), i_InstanceId);
+    for (std::list<PreparedGridMap>::iterator itr = _preparedGridMaps.begin(); itr != _preparedGridMaps.end(); ++itr)
+        delete itr->gridMap;
 }
 
 bool Map::ExistMap(uint32 mapid, int gx, int gy)
@@ -186,6 +189,17 @@ void Map::LoadMap(int gx, int gy, bool reload)
         GridMaps[gx][gy]=NULL;
     }
 
+    // terrain already read by the grid prefetcher
+    GridMap* prepared = TakePreparedGridMap(gx, gy);
+    if (prepared && !reload)
+    {
+        TC_LOG_DEBUG("maps", "Loading prefetched map %03u%02u%02u.map", GetId(), gx, gy);
+        GridMaps[gx][gy] = prepared;
+        sScriptMgr->OnLoadGridMap(this, GridMaps[gx][gy], gx, gy);
+        return;
+    }
+    delete prepared;
+
     // map file name
     char* tmp = NULL;
     int len = sWorld->GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
@@ -201,8 +215,129 @@ void Map::LoadMap(int gx, int gy, bool reload)
     sScriptMgr->OnLoadGridMap(this, GridMaps[gx][gy], gx, gy);
 }
 
+// Reads the whole file and drops the data, so the next read of it is served from the file cache
+static void WarmFileCache(std::string const& fileName)
+{
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (!file)
+        return;
+
+    char buffer[64 * 1024];
+    while (fread(buffer, 1, sizeof(buffer), file) == sizeof(buffer))
+        ;
+    fclose(file);
+}
+
+void Map::PrepareGridMap(int gx, int gy)
+{
+    char fileName[1024];
+    snprintf(fileName, sizeof(fileName), (sWorld->GetDataPath() + "maps/%03u%02u%02u.map").c_str(), GetId(), gx, gy);
+    TC_LOG_DEBUG("maps", "Prefetching map %s", fileName);
+
+    GridMap* gridMap = new GridMap();
+    if (!gridMap->loadData(fileName))
+        TC_LOG_ERROR("maps", "Error loading map file: \n %s\n", fileName);
+
+    if (VMAP::VMapFactory::createOrGetVMapManager()->isMapLoadingEnabled())
+        WarmFileCache(sWorld->GetDataPath() + "vmaps/" + VMAP::StaticMapTree::getTileFileName(GetId(), gx, gy));
+
+    if (MMAP::MMapFactory::IsPathfindingEnabled(GetId()))
+    {
+        snprintf(fileName, sizeof(fileName), (sWorld->GetDataPath() + "mmaps/%03i%02i%02i.mmtile").c_str(), GetId(), gx, gy);
+        WarmFileCache(fileName);
+    }
+
+    std::lock_guard<std::mutex> lock(_preparedGridMapsLock);
+    for (std::list<PreparedGridMap>::iterator itr = _preparedGridMaps.begin(); itr != _preparedGridMaps.end(); ++itr)
+    {
+        if (itr->gx == gx && itr->gy == gy)
+        {
+            itr->gridMap = gridMap;
+            return;
+        }
+    }
+
+    // the grid was entered and loaded before the prefetch finished
+    delete gridMap;
+}
+
+void Map::SchedulePrefetch(int gx, int gy)
+{
+    {
+        std::lock_guard<std::mutex> lock(_preparedGridMapsLock);
+        for (std::list<PreparedGridMap>::const_iterator itr = _preparedGridMaps.begin(); itr != _preparedGridMaps.end(); ++itr)
+            if (itr->gx == gx && itr->gy == gy)
+                return;
+
+        // make room by dropping the oldest terrain nobody walked into
+        if (_preparedGridMaps.size() >= MAX_PREPARED_GRID_MAPS)
+        {
+            std::list<PreparedGridMap>::iterator itr = _preparedGridMaps.begin();
+            while (itr != _preparedGridMaps.end() && !itr->gridMap)
+                ++itr;
+            if (itr == _preparedGridMaps.end())
+                return;
+
+            delete itr->gridMap;
+            _preparedGridMaps.erase(itr);
+        }
+
+        _preparedGridMaps.push_back(PreparedGridMap(gx, gy));
+    }
+
+    sMapMgr->GetGridPrefetcher()->schedule_prefetch(*this, gx, gy);
+}
+
+GridMap* Map::TakePreparedGridMap(int gx, int gy)
+{
+    std::lock_guard<std::mutex> lock(_preparedGridMapsLock);
+    for (std::list<PreparedGridMap>::iterator itr = _preparedGridMaps.begin(); itr != _preparedGridMaps.end(); ++itr)
+    {
+        if (itr->gx == gx && itr->gy == gy)
+        {
+            // an in flight prefetch finds no entry and drops its result
+            GridMap* gridMap = itr->gridMap;
+            _preparedGridMaps.erase(itr);
+            return gridMap;
+        }
+    }
+
+    return NULL;
+}
+
+// Checks the grids along the heading of a moving player and prefetches the ones not loaded yet.
+// Instanceable maps share their terrain with the parent map and are not prefetched.
+void Map::PrefetchGridsAhead(Player* player)
+{
+    if (Instanceable() || !player->isMoving() || !sMapMgr->GetGridPrefetcher()->activated())
+        return;
+
+    float speed = player->GetSpeed(player->IsFlying() ? MOVE_FLIGHT : MOVE_RUN);
+    float distance = speed * sWorld->getIntConfig(CONFIG_GRID_PREFETCH_LOOKAHEAD) / IN_MILLISECONDS;
+    float angle = player->GetOrientation();
+
+    // step half a grid at a time so a fast mover does not skip the grid in between
+    for (float step = SIZE_OF_GRIDS / 2; ; step += SIZE_OF_GRIDS / 2)
+    {
+        float travelled = std::min(step, distance);
+        GridCoord p = Trinity::ComputeGridCoord(player->GetPositionX() + travelled * std::cos(angle), player->GetPositionY() + travelled * std::sin(angle));
+        if (p.IsCoordValid())
+        {
+            int gx = (MAX_NUMBER_OF_GRIDS - 1) - p.x_coord;
+            int gy = (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord;
+            if (!GridMaps[gx][gy])
+                SchedulePrefetch(gx, gy);
+        }
+
+        if (step >= distance)
+            break;
+    }
+}
+
 void Map::LoadMapAndVMap(int gx, int gy)
 {
+    // results traced before the tile was there miss its geometry
+    _lineOfSightCache.Clear();
     LoadMap(gx, gy);
    // Only load the data for the base map
     if (i_InstanceId == 0)
@@ -234,10 +369,11 @@ i_mapEntry(sMapStore.LookupEntry(id)), i_spawnMode(SpawnMode), i_InstanceId(Inst
 m_unloadTimer(0), m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
 m_VisibilityNotifyPeriod(DEFAULT_VISIBILITY_NOTIFY_PERIOD),
 m_activeNonPlayersIter(m_activeNonPlayers.end()), _transportsUpdateIter(_transports.end()),
-i_gridExpiry(expiry),
+i_gridExpiry(expiry), i_deferVisibility(false),
 i_scriptLock(false), _defaultLight(GetDefaultMapLight(id))
 {
     m_parentMap = (_parent ? _parent : this);
+    _lineOfSightCache.Initialize(sWorld->getFloatConfig(CONFIG_LOS_CACHE_GRID_SIZE), sWorld->getIntConfig(CONFIG_LOS_CACHE_TTL));
     for (unsigned int idx=0; idx < MAX_NUMBER_OF_GRIDS; ++idx)
     {
         for (unsigned int j=0; j < MAX_NUMBER_OF_GRIDS; ++j)
@@ -436,6 +572,7 @@ void Map::EnsureGridLoadedForActiveObject(const Cell &cell, WorldObject* object)
         TC_LOG_DEBUG("maps", "Active object %s triggers loading of grid [%u, %u] on map %u", object->GetGUID().ToString().c_str(), cell.GridX(), cell.GridY(), GetId());
         ResetGridExpiry(*grid, 0.1f);
         grid->SetGridState(GRID_STATE_ACTIVE);
+        sMapMgr->GetGridResidency()->OnGridActive(*this, cell.GridX(), cell.GridY());
     }
 }
 
@@ -457,7 +594,7 @@ bool Map::EnsureGridLoaded(const Cell &cell)
 
         // Add resurrectable corpses to world object list in grid
         sObjectAccessor->AddCorpsesToGrid(GridCoord(cell.GridX(), cell.GridY()), grid->GetGridType(cell.CellX(), cell.CellY()), this);
-        Balance();
+        sMapMgr->GetGridResidency()->OnGridLoaded(*this, cell.GridX(), cell.GridY());
         return true;
     }
 
@@ -469,6 +606,12 @@ void Map::LoadGrid(float x, float y)
     EnsureGridLoaded(Cell(x, y));
 }
 
+void Map::PinGrid(GridCoord const& p)
+{
+    EnsureGridLoaded(Cell(CellCoord(p.x_coord * MAX_NUMBER_OF_CELLS, p.y_coord * MAX_NUMBER_OF_CELLS)));
+    SetUnloadLock(p, true);
+}
+
 bool Map::AddPlayerToMap(Player* player)
 {
     CellCoord cellCoord = Trinity::ComputeCellCoord(player->GetPositionX(), player->GetPositionY());
@@ -599,6 +742,15 @@ bool Map::IsGridLoaded(const GridCoord &p) const
     return (getNGrid(p.x_coord, p.y_coord) && isGridObjectDataLoaded(p.x_coord, p.y_coord));
 }
 
+CellPositionIndex const* Map::GetPlayerPositionIndex(CellCoord const& p) const
+{
+    Cell cell(p);
+    if (!IsGridLoaded(GridCoord(cell.GridX(), cell.GridY())))
+        return NULL;
+
+    return &getNGrid(cell.GridX(), cell.GridY())->GetGridType(cell.CellX(), cell.CellY()).GetActiveObjectIndex();
+}
+
 void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor)
 {
     // Check for valid position
@@ -630,7 +782,6 @@ void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::Obj
 
 void Map::Update(const uint32 t_diff)
 {
-    _dynamicTree.update(t_diff);
     /// update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
@@ -729,38 +880,47 @@ void Map::ProcessRelocationNotifies(const uint32 diff)
             continue;
 
         grid->getGridInfoRef()->getRelocationTimer().TUpdate(diff);
-        if (!grid->getGridInfoRef()->getRelocationTimer().TPassed())
-            continue;
-
-        uint32 gx = grid->getX(), gy = grid->getY();
-
-        CellCoord cell_min(gx*MAX_NUMBER_OF_CELLS, gy*MAX_NUMBER_OF_CELLS);
-        CellCoord cell_max(cell_min.x_coord + MAX_NUMBER_OF_CELLS, cell_min.y_coord+MAX_NUMBER_OF_CELLS);
+    }
 
-        for (uint32 x = cell_min.x_coord; x < cell_max.x_coord; ++x)
-        {
-            for (uint32 y = cell_min.y_coord; y < cell_max.y_coord; ++y)
-            {
-                uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                if (!isCellMarked(cell_id))
-                    continue;
+    // only cells marked during this tick can hold objects waiting for a notify
+    i_deferVisibility = true;
+    for (std::vector<uint32>::const_iterator itr = marked_cell_ids.begin(); itr != marked_cell_ids.end(); ++itr)
+    {
+        CellCoord pair(*itr % TOTAL_NUMBER_OF_CELLS_PER_MAP, *itr / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+        if (!IsRelocationDue(pair))
+            continue;
 
-                CellCoord pair(x, y);
-                Cell cell(pair);
-                cell.SetNoCreate();
+        Cell cell(pair);
+        cell.SetNoCreate();
 
-                Trinity::DelayedUnitRelocation cell_relocation(cell, pair, *this, MAX_VISIBILITY_DISTANCE);
-                TypeContainerVisitor<Trinity::DelayedUnitRelocation, GridTypeMapContainer  > grid_object_relocation(cell_relocation);
-                TypeContainerVisitor<Trinity::DelayedUnitRelocation, WorldTypeMapContainer > world_object_relocation(cell_relocation);
-                Visit(cell, grid_object_relocation);
-                Visit(cell, world_object_relocation);
-            }
-        }
+        Trinity::DelayedUnitRelocation cell_relocation(cell, pair, *this, MAX_VISIBILITY_DISTANCE);
+        TypeContainerVisitor<Trinity::DelayedUnitRelocation, GridTypeMapContainer  > grid_object_relocation(cell_relocation);
+        TypeContainerVisitor<Trinity::DelayedUnitRelocation, WorldTypeMapContainer > world_object_relocation(cell_relocation);
+        Visit(cell, grid_object_relocation);
+        Visit(cell, world_object_relocation);
     }
+    i_deferVisibility = false;
+
+    for (GuidVector::const_iterator itr = i_deferredVisibility.begin(); itr != i_deferredVisibility.end(); ++itr)
+        if (Player* player = ObjectAccessor::GetObjectInMap(*itr, this, (Player*)NULL))
+            player->SendDeferredVisibility();
+    i_deferredVisibility.clear();
 
     ResetNotifier reset;
     TypeContainerVisitor<ResetNotifier, GridTypeMapContainer >  grid_notifier(reset);
     TypeContainerVisitor<ResetNotifier, WorldTypeMapContainer > world_notifier(reset);
+    for (std::vector<uint32>::const_iterator itr = marked_cell_ids.begin(); itr != marked_cell_ids.end(); ++itr)
+    {
+        CellCoord pair(*itr % TOTAL_NUMBER_OF_CELLS_PER_MAP, *itr / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+        if (!IsRelocationDue(pair))
+            continue;
+
+        Cell cell(pair);
+        cell.SetNoCreate();
+        Visit(cell, grid_notifier);
+        Visit(cell, world_notifier);
+    }
+
     for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end(); ++i)
     {
         NGridType *grid = i->GetSource();
@@ -772,28 +932,18 @@ void Map::ProcessRelocationNotifies(const uint32 diff)
             continue;
 
         grid->getGridInfoRef()->getRelocationTimer().TReset(diff, m_VisibilityNotifyPeriod);
+    }
+}
 
-        uint32 gx = grid->getX(), gy = grid->getY();
-
-        CellCoord cell_min(gx*MAX_NUMBER_OF_CELLS, gy*MAX_NUMBER_OF_CELLS);
-        CellCoord cell_max(cell_min.x_coord + MAX_NUMBER_OF_CELLS, cell_min.y_coord+MAX_NUMBER_OF_CELLS);
-
-        for (uint32 x = cell_min.x_coord; x < cell_max.x_coord; ++x)
-        {
-            for (uint32 y = cell_min.y_coord; y < cell_max.y_coord; ++y)
-            {
-                uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                if (!isCellMarked(cell_id))
-                    continue;
+void Map::AddDeferredVisibility(Player* player)
+{
+    i_deferredVisibility.push_back(player->GetGUID());
+}
 
-                CellCoord pair(x, y);
-                Cell cell(pair);
-                cell.SetNoCreate();
-                Visit(cell, grid_notifier);
-                Visit(cell, world_notifier);
-            }
-        }
-    }
+bool Map::IsRelocationDue(CellCoord const& p) const
+{
+    NGridType* grid = getNGrid(p.x_coord / MAX_NUMBER_OF_CELLS, p.y_coord / MAX_NUMBER_OF_CELLS);
+    return grid && grid->GetGridState() == GRID_STATE_ACTIVE && grid->getGridInfoRef()->getRelocationTimer().TPassed();
 }
 
 void Map::RemovePlayerFromMap(Player* player, bool remove)
@@ -805,7 +955,10 @@ void Map::RemovePlayerFromMap(Player* player, bool remove)
 
     player->UpdateObjectVisibility(true);
     if (player->IsInGrid())
+    {
+        player->RemoveFromPositionIndex();
         player->RemoveFromGrid();
+    }
     else
         ASSERT(remove); //maybe deleted in logoutplayer when player is not in a map
 
@@ -891,10 +1044,12 @@ void Map::PlayerRelocation(Player* player, float x, float y, float z, float orie
     if (player->IsVehicle())
         player->GetVehicleKit()->RelocatePassengers();
 
-    if (old_cell.DiffGrid(new_cell) || old_cell.DiffCell(new_cell))
+    bool cellChanged = old_cell.DiffGrid(new_cell) || old_cell.DiffCell(new_cell);
+    if (cellChanged)
     {
         TC_LOG_DEBUG("maps", "Player %s relocation grid[%u, %u]cell[%u, %u]->grid[%u, %u]cell[%u, %u]", player->GetName().c_str(), old_cell.GridX(), old_cell.GridY(), old_cell.CellX(), old_cell.CellY(), new_cell.GridX(), new_cell.GridY(), new_cell.CellX(), new_cell.CellY());
 
+        player->RemoveFromPositionIndex();
         player->RemoveFromGrid();
 
         if (old_cell.DiffGrid(new_cell))
@@ -902,8 +1057,19 @@ void Map::PlayerRelocation(Player* player, float x, float y, float z, float orie
 
         AddToGrid(player, new_cell);
     }
+    else
+        player->UpdatePositionIndex();
 
-    player->UpdateObjectVisibility(false);
+    PrefetchGridsAhead(player);
+
+    // steps inside the same cell only reschedule the visibility update once the player got far enough from the last one,
+    // this update also runs the aggro checks of nearby creatures
+    float lowerLimit = sWorld->getFloatConfig(CONFIG_VISIBILITY_RELOCATION_LOWER_LIMIT);
+    if (cellChanged || player->GetExactDist2dSq(&player->m_lastVisibilityRelocation) >= lowerLimit * lowerLimit)
+    {
+        player->m_lastVisibilityRelocation.Relocate(player);
+        player->UpdateObjectVisibility(false);
+    }
 }
 
 void Map::CreatureRelocation(Creature* creature, float x, float y, float z, float ang, bool respawnRelocationOnFail)
@@ -1493,6 +1659,9 @@ bool Map::UnloadGrid(NGridType& ngrid, bool unloadAll)
 
         ASSERT(i_objectsToRemove.empty());
 
+        if (ngrid.isGridObjectDataLoaded())
+            sMapMgr->GetGridResidency()->OnGridUnloaded(*this, x, y);
+
         delete &ngrid;
         setNGrid(NULL, x, y);
     }
@@ -1769,16 +1938,10 @@ uint16 GridMap::getArea(float x, float y) const
     return _areaMap[lx*16 + ly];
 }
 
-float GridMap::getHeightFromFlat(float /*x*/, float /*y*/) const
-{
-    return _gridHeight;
-}
-
-float GridMap::getHeightFromFloat(float x, float y) const
+// Height of (x, y) in the storage units of the V9 and V8 grids, the same for every storage format
+template<class T>
+static inline float InterpolateGridHeight(T const* V9, T const* V8, float x, float y)
 {
-    if (!m_V8 || !m_V9)
-        return _gridHeight;
-
     x = MAP_RESOLUTION * (CENTER_GRID_ID - x/SIZE_OF_GRIDS);
     y = MAP_RESOLUTION * (CENTER_GRID_ID - y/SIZE_OF_GRIDS);
 
@@ -1804,6 +1967,8 @@ float GridMap::getHeightFromFloat(float x, float y) const
     // 2 - solve linear equation from triangle points
     // Calculate coefficients for solve h = a*x + b*y + c
 
+    T const* V9_h1_ptr = &V9[x_int*128 + x_int + y_int];
+    float h5 = 2.0f * V8[x_int*128 + y_int];
     float a, b, c;
     // Select triangle:
     if (x+y < 1)
@@ -1811,9 +1976,8 @@ float GridMap::getHeightFromFloat(float x, float y) const
         if (x > y)
         {
             // 1 triangle (h1, h2, h5 points)
-            float h1 = m_V9[(x_int)*129 + y_int];
-            float h2 = m_V9[(x_int+1)*129 + y_int];
-            float h5 = 2 * m_V8[x_int*128 + y_int];
+            float h1 = V9_h1_ptr[  0];
+            float h2 = V9_h1_ptr[129];
             a = h2-h1;
             b = h5-h1-h2;
             c = h1;
@@ -1821,9 +1985,8 @@ float GridMap::getHeightFromFloat(float x, float y) const
         else
         {
             // 2 triangle (h1, h3, h5 points)
-            float h1 = m_V9[x_int*129 + y_int  ];
-            float h3 = m_V9[x_int*129 + y_int+1];
-            float h5 = 2 * m_V8[x_int*128 + y_int];
+            float h1 = V9_h1_ptr[0];
+            float h3 = V9_h1_ptr[1];
             a = h5 - h1 - h3;
             b = h3 - h1;
             c = h1;
@@ -1834,9 +1997,8 @@ float GridMap::getHeightFromFloat(float x, float y) const
         if (x > y)
         {
             // 3 triangle (h2, h4, h5 points)
-            float h2 = m_V9[(x_int+1)*129 + y_int  ];
-            float h4 = m_V9[(x_int+1)*129 + y_int+1];
-            float h5 = 2 * m_V8[x_int*128 + y_int];
+            float h2 = V9_h1_ptr[129];
+            float h4 = V9_h1_ptr[130];
             a = h2 + h4 - h5;
             b = h4 - h2;
             c = h5 - h4;
@@ -1844,9 +2006,8 @@ float GridMap::getHeightFromFloat(float x, float y) const
         else
         {
             // 4 triangle (h3, h4, h5 points)
-            float h3 = m_V9[(x_int)*129 + y_int+1];
-            float h4 = m_V9[(x_int+1)*129 + y_int+1];
-            float h5 = 2 * m_V8[x_int*128 + y_int];
+            float h3 = V9_h1_ptr[  1];
+            float h4 = V9_h1_ptr[130];
             a = h4 - h3;
             b = h3 + h4 - h5;
             c = h5 - h4;
@@ -1856,71 +2017,25 @@ float GridMap::getHeightFromFloat(float x, float y) const
     return a * x + b * y + c;
 }
 
-float GridMap::getHeightFromUint8(float x, float y) const
+float GridMap::getHeightFromFlat(float /*x*/, float /*y*/) const
 {
-    if (!m_uint8_V8 || !m_uint8_V9)
+    return _gridHeight;
+}
+
+float GridMap::getHeightFromFloat(float x, float y) const
+{
+    if (!m_V8 || !m_V9)
         return _gridHeight;
 
-    x = MAP_RESOLUTION * (CENTER_GRID_ID - x/SIZE_OF_GRIDS);
-    y = MAP_RESOLUTION * (CENTER_GRID_ID - y/SIZE_OF_GRIDS);
+    return InterpolateGridHeight(m_V9, m_V8, x, y);
+}
 
-    int x_int = (int)x;
-    int y_int = (int)y;
-    x -= x_int;
-    y -= y_int;
-    x_int&=(MAP_RESOLUTION - 1);
-    y_int&=(MAP_RESOLUTION - 1);
+float GridMap::getHeightFromUint8(float x, float y) const
+{
+    if (!m_uint8_V8 || !m_uint8_V9)
+        return _gridHeight;
 
-    int32 a, b, c;
-    uint8 *V9_h1_ptr = &m_uint8_V9[x_int*128 + x_int + y_int];
-    if (x+y < 1)
-    {
-        if (x > y)
-        {
-            // 1 triangle (h1, h2, h5 points)
-            int32 h1 = V9_h1_ptr[  0];
-            int32 h2 = V9_h1_ptr[129];
-            int32 h5 = 2 * m_uint8_V8[x_int*128 + y_int];
-            a = h2-h1;
-            b = h5-h1-h2;
-            c = h1;
-        }
-        else
-        {
-            // 2 triangle (h1, h3, h5 points)
-            int32 h1 = V9_h1_ptr[0];
-            int32 h3 = V9_h1_ptr[1];
-            int32 h5 = 2 * m_uint8_V8[x_int*128 + y_int];
-            a = h5 - h1 - h3;
-            b = h3 - h1;
-            c = h1;
-        }
-    }
-    else
-    {
-        if (x > y)
-        {
-            // 3 triangle (h2, h4, h5 points)
-            int32 h2 = V9_h1_ptr[129];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint8_V8[x_int*128 + y_int];
-            a = h2 + h4 - h5;
-            b = h4 - h2;
-            c = h5 - h4;
-        }
-        else
-        {
-            // 4 triangle (h3, h4, h5 points)
-            int32 h3 = V9_h1_ptr[  1];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint8_V8[x_int*128 + y_int];
-            a = h4 - h3;
-            b = h3 + h4 - h5;
-            c = h5 - h4;
-        }
-    }
-    // Calculate height
-    return (float)((a * x) + (b * y) + c)*_gridIntHeightMultiplier + _gridHeight;
+    return InterpolateGridHeight(m_uint8_V9, m_uint8_V8, x, y) * _gridIntHeightMultiplier + _gridHeight;
 }
 
 float GridMap::getHeightFromUint16(float x, float y) const
@@ -1928,66 +2043,29 @@ float GridMap::getHeightFromUint16(float x, float y) const
     if (!m_uint16_V8 || !m_uint16_V9)
         return _gridHeight;
 
-    x = MAP_RESOLUTION * (CENTER_GRID_ID - x/SIZE_OF_GRIDS);
-    y = MAP_RESOLUTION * (CENTER_GRID_ID - y/SIZE_OF_GRIDS);
-
-    int x_int = (int)x;
-    int y_int = (int)y;
-    x -= x_int;
-    y -= y_int;
-    x_int&=(MAP_RESOLUTION - 1);
-    y_int&=(MAP_RESOLUTION - 1);
+    return InterpolateGridHeight(m_uint16_V9, m_uint16_V8, x, y) * _gridIntHeightMultiplier + _gridHeight;
+}
 
-    int32 a, b, c;
-    uint16 *V9_h1_ptr = &m_uint16_V9[x_int*128 + x_int + y_int];
-    if (x+y < 1)
+void GridMap::getHeights(float const* x, float const* y, float* heights, uint32 count) const
+{
+    // the storage format is resolved once, the loops below inline the interpolation
+    if (!m_V8 || !m_V9 || _gridGetHeight == &GridMap::getHeightFromFlat)
+        std::fill(heights, heights + count, _gridHeight);
+    else if (_gridGetHeight == &GridMap::getHeightFromFloat)
     {
-        if (x > y)
-        {
-            // 1 triangle (h1, h2, h5 points)
-            int32 h1 = V9_h1_ptr[  0];
-            int32 h2 = V9_h1_ptr[129];
-            int32 h5 = 2 * m_uint16_V8[x_int*128 + y_int];
-            a = h2-h1;
-            b = h5-h1-h2;
-            c = h1;
-        }
-        else
-        {
-            // 2 triangle (h1, h3, h5 points)
-            int32 h1 = V9_h1_ptr[0];
-            int32 h3 = V9_h1_ptr[1];
-            int32 h5 = 2 * m_uint16_V8[x_int*128 + y_int];
-            a = h5 - h1 - h3;
-            b = h3 - h1;
-            c = h1;
-        }
+        for (uint32 i = 0; i < count; ++i)
+            heights[i] = InterpolateGridHeight(m_V9, m_V8, x[i], y[i]);
+    }
+    else if (_gridGetHeight == &GridMap::getHeightFromUint16)
+    {
+        for (uint32 i = 0; i < count; ++i)
+            heights[i] = InterpolateGridHeight(m_uint16_V9, m_uint16_V8, x[i], y[i]) * _gridIntHeightMultiplier + _gridHeight;
     }
     else
     {
-        if (x > y)
-        {
-            // 3 triangle (h2, h4, h5 points)
-            int32 h2 = V9_h1_ptr[129];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint16_V8[x_int*128 + y_int];
-            a = h2 + h4 - h5;
-            b = h4 - h2;
-            c = h5 - h4;
-        }
-        else
-        {
-            // 4 triangle (h3, h4, h5 points)
-            int32 h3 = V9_h1_ptr[  1];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint16_V8[x_int*128 + y_int];
-            a = h4 - h3;
-            b = h3 + h4 - h5;
-            c = h5 - h4;
-        }
+        for (uint32 i = 0; i < count; ++i)
+            heights[i] = InterpolateGridHeight(m_uint8_V9, m_uint8_V8, x[i], y[i]) * _gridIntHeightMultiplier + _gridHeight;
     }
-    // Calculate height
-    return (float)((a * x) + (b * y) + c)*_gridIntHeightMultiplier + _gridHeight;
 }
 
 float GridMap::getLiquidLevel(float x, float y) const
@@ -2149,16 +2227,21 @@ float Map::GetWaterOrGroundLevel(float x, float y, float z, float* ground /*= NU
 }
 
 float Map::GetHeight(float x, float y, float z, bool checkVMap /*= true*/, float maxSearchDist /*= DEFAULT_HEIGHT_SEARCH*/) const
+{
+    float gridHeight = VMAP_INVALID_HEIGHT_VALUE;
+    if (GridMap* gmap = const_cast<Map*>(this)->GetGrid(x, y))
+        gridHeight = gmap->getHeight(x, y);
+
+    return SelectHeight(x, y, z, gridHeight, checkVMap, maxSearchDist);
+}
+
+float Map::SelectHeight(float x, float y, float z, float gridHeight, bool checkVMap, float maxSearchDist) const
 {
     // find raw .map surface under Z coordinates
     float mapHeight = VMAP_INVALID_HEIGHT_VALUE;
-    if (GridMap* gmap = const_cast<Map*>(this)->GetGrid(x, y))
-    {
-        float gridHeight = gmap->getHeight(x, y);
-        // look from a bit higher pos to find the floor, ignore under surface case
-        if (z + 2.0f > gridHeight)
-            mapHeight = gridHeight;
-    }
+    // look from a bit higher pos to find the floor, ignore under surface case
+    if (z + 2.0f > gridHeight)
+        mapHeight = gridHeight;
 
     float vmapHeight = VMAP_INVALID_HEIGHT_VALUE;
     if (checkVMap)
@@ -2190,6 +2273,28 @@ float Map::GetHeight(float x, float y, float z, bool checkVMap /*= true*/, float
     return mapHeight;                               // explicitly use map data
 }
 
+void Map::GetGridHeights(float const* x, float const* y, float* heights, uint32 count) const
+{
+    // consecutive points of one grid are sampled together
+    uint32 first = 0;
+    while (first < count)
+    {
+        int gx = (int)(CENTER_GRID_ID - x[first]/SIZE_OF_GRIDS);
+        int gy = (int)(CENTER_GRID_ID - y[first]/SIZE_OF_GRIDS);
+
+        uint32 last = first + 1;
+        while (last < count && (int)(CENTER_GRID_ID - x[last]/SIZE_OF_GRIDS) == gx && (int)(CENTER_GRID_ID - y[last]/SIZE_OF_GRIDS) == gy)
+            ++last;
+
+        if (GridMap* gmap = const_cast<Map*>(this)->GetGrid(x[first], y[first]))
+            gmap->getHeights(x + first, y + first, heights + first, last - first);
+        else
+            std::fill(heights + first, heights + last, VMAP_INVALID_HEIGHT_VALUE);
+
+        first = last;
+    }
+}
+
 inline bool IsOutdoorWMO(uint32 mogpFlags, int32 /*adtId*/, int32 /*rootId*/, int32 /*groupId*/, WMOAreaTableEntry const* wmoEntry, AreaTableEntry const* atEntry)
 {
     bool outdoor = true;
@@ -2420,10 +2525,77 @@ void Map::GetZoneAndAreaIdByAreaFlag(uint32& zoneid, uint32& areaid, uint16 area
     zoneid = entry ? ((entry->zone != 0) ? entry->zone : entry->ID) : 0;
 }
 
+void Map::RelocateGameObjectModel(const GameObjectModel& model, G3D::AABox const& oldBounds)
+{
+    _dynamicTree.relocate(model);
+
+    G3D::AABox bounds = oldBounds;
+    bounds.merge(model.getBounds());
+    _lineOfSightCache.Invalidate(bounds);
+}
+
 bool Map::isInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2)
+    if (!_lineOfSightCache.IsEnabled())
+        return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2)
+            && _dynamicTree.isInLineOfSight(x1, y1, z1, x2, y2, z2, phasemask);
+
+    bool inSight;
+    if (_lineOfSightCache.Lookup(x1, y1, z1, x2, y2, z2, phasemask, inSight))
+        return inSight;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    inSight = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2)
         && _dynamicTree.isInLineOfSight(x1, y1, z1, x2, y2, z2, phasemask);
+    uint32 traceTimeUs = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+    _lineOfSightCache.Store(x1, y1, z1, x2, y2, z2, phasemask, inSight, traceTimeUs);
+    return inSight;
+}
+
+void Map::isInLineOfSight(std::vector<VMAP::LineOfSightRay>& rays) const
+{
+    if (!_lineOfSightCache.IsEnabled())
+    {
+        VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), rays);
+        _dynamicTree.isInLineOfSight(rays);
+        return;
+    }
+
+    // rays already blocked are left alone, only the ones without a live cached result are traced
+    std::vector<VMAP::LineOfSightRay> misses;
+    std::vector<uint32> missIndexes;
+    for (uint32 i = 0; i < rays.size(); ++i)
+    {
+        VMAP::LineOfSightRay& ray = rays[i];
+        if (!ray.inLineOfSight)
+            continue;
+
+        bool inSight;
+        if (_lineOfSightCache.Lookup(ray.x1, ray.y1, ray.z1, ray.x2, ray.y2, ray.z2, ray.phaseMask, inSight))
+            ray.inLineOfSight = inSight;
+        else
+        {
+            misses.push_back(ray);
+            missIndexes.push_back(i);
+        }
+    }
+
+    if (misses.empty())
+        return;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), misses);
+    _dynamicTree.isInLineOfSight(misses);
+    uint32 traceTimeUs = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+    for (uint32 i = 0; i < misses.size(); ++i)
+    {
+        VMAP::LineOfSightRay const& ray = misses[i];
+        rays[missIndexes[i]].inLineOfSight = ray.inLineOfSight;
+        // the batch is timed as a whole, its time is added once
+        _lineOfSightCache.Store(ray.x1, ray.y1, ray.z1, ray.x2, ray.y2, ray.z2, ray.phaseMask, ray.inLineOfSight, i ? 0 : traceTimeUs);
+    }
 }
 
 bool Map::getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float& ry, float& rz, float modifyDist)
@@ -2445,6 +2617,27 @@ float Map::GetHeight(uint32 phasemask, float x, float y, float z, bool vmap/*=tr
     return std::max<float>(GetHeight(x, y, z, vmap, maxSearchDist), _dynamicTree.getHeight(x, y, z, maxSearchDist, phasemask));
 }
 
+void Map::GetHeights(uint32 phasemask, std::vector<G3D::Vector3> const& points, std::vector<float>& heights, bool vmap /*= true*/, float maxSearchDist /*= DEFAULT_HEIGHT_SEARCH*/) const
+{
+    uint32 count = uint32(points.size());
+    std::vector<float> x(count), y(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        x[i] = points[i].x;
+        y[i] = points[i].y;
+    }
+
+    heights.resize(count);
+    GetGridHeights(x.data(), y.data(), heights.data(), count);
+
+    // vmaps and gameobjects are still traced one point at a time
+    for (uint32 i = 0; i < count; ++i)
+    {
+        G3D::Vector3 const& point = points[i];
+        heights[i] = std::max<float>(SelectHeight(point.x, point.y, point.z, heights[i], vmap, maxSearchDist), _dynamicTree.getHeight(point.x, point.y, point.z, maxSearchDist, phasemask));
+    }
+}
+
 bool Map::IsInWater(float x, float y, float pZ, LiquidData* data) const
 {
     LiquidData liquid_status;
@@ -2496,6 +2689,7 @@ void Map::UpdateObjectsVisibilityFor(Player* player, Cell cell, CellCoord cellpa
     TypeContainerVisitor<Trinity::VisibleNotifier, GridTypeMapContainer  > grid_notifier(notifier);
     cell.Visit(cellpair, world_notifier, *this, *player, player->GetSightRange());
     cell.Visit(cellpair, grid_notifier,  *this, *player, player->GetSightRange());
+    notifier.VisitPlayers(*player, player->GetSightRange() + player->GetObjectSize());
 
     // send data
     notifier.SendToSelf();
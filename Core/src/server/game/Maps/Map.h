@@ -31,6 +31,7 @@
 #include "DynamicTree.h"
 #include "GameObjectModel.h"
 #include "ObjectGuid.h"
+#include "LineOfSightCache.h"
 
 #include <bitset>
 #include <list>
@@ -205,6 +206,8 @@ public:
 
     uint16 getArea(float x, float y) const;
     inline float getHeight(float x, float y) const {return (this->*_gridGetHeight)(x, y);}
+    // Heights of count points that all lie in this grid, without a call through _gridGetHeight per point
+    void getHeights(float const* x, float const* y, float* heights, uint32 count) const;
     float getLiquidLevel(float x, float y) const;
     uint8 getTerrainType(float x, float y) const;
     ZLiquidStatus getLiquidStatus(float x, float y, float z, uint8 ReqLiquidType, LiquidData* data = 0);
@@ -252,6 +255,7 @@ struct ZoneDynamicInfo
 #define MAX_FALL_DISTANCE     250000.0f                     // "unlimited fall" to find VMap ground if it is available, just larger than MAX_HEIGHT - INVALID_HEIGHT
 #define DEFAULT_HEIGHT_SEARCH     50.0f                     // default search distance to find height at nearby locations
 #define MIN_UNLOAD_DELAY      1                             // immediate unload
+#define MAX_PREPARED_GRID_MAPS 8                            // prefetched terrain kept per map until its grid is entered
 
 typedef std::map<uint32/*leaderDBGUID*/, CreatureGroup*>        CreatureGroupHolderType;
 
@@ -312,6 +316,8 @@ class Map : public GridRefManager<NGridType>
         bool GetUnloadLock(const GridCoord &p) const { return getNGrid(p.x_coord, p.y_coord)->getUnloadLock(); }
         void SetUnloadLock(const GridCoord &p, bool on) { getNGrid(p.x_coord, p.y_coord)->setUnloadExplicitLock(on); }
         void LoadGrid(float x, float y);
+        // Loads the grid and keeps it loaded for the lifetime of the map
+        void PinGrid(GridCoord const& p);
         bool UnloadGrid(NGridType& ngrid, bool pForce);
         virtual void UnloadAll();
 
@@ -413,9 +419,26 @@ class Map : public GridRefManager<NGridType>
         void UpdateObjectVisibility(WorldObject* obj, Cell cell, CellCoord cellpair);
         void UpdateObjectsVisibilityFor(Player* player, Cell cell, CellCoord cellpair);
 
-        void resetMarkedCells() { marked_cells.reset(); }
+        // While relocation notifies run, visibility changes are gathered per player and sent once at the end of the pass
+        bool IsDeferringVisibility() const { return i_deferVisibility; }
+        void AddDeferredVisibility(Player* player);
+
+        // only the bits set during this tick are cleared, idle maps pay nothing for the full bitset
+        void resetMarkedCells()
+        {
+            for (std::vector<uint32>::const_iterator itr = marked_cell_ids.begin(); itr != marked_cell_ids.end(); ++itr)
+                marked_cells.reset(*itr);
+            marked_cell_ids.clear();
+        }
         bool isCellMarked(uint32 pCellId) { return marked_cells.test(pCellId); }
-        void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
+        void markCell(uint32 pCellId)
+        {
+            if (marked_cells.test(pCellId))
+                return;
+
+            marked_cells.set(pCellId);
+            marked_cell_ids.push_back(pCellId);
+        }
 
         bool HavePlayers() const { return !m_mapRefManager.isEmpty(); }
         uint32 GetPlayersCountExceptGMs() const;
@@ -446,6 +469,13 @@ class Map : public GridRefManager<NGridType>
         template<class NOTIFIER> void VisitFirstFound(const float &x, const float &y, float radius, NOTIFIER &notifier);
         template<class NOTIFIER> void VisitWorld(const float &x, const float &y, float radius, NOTIFIER &notifier);
         template<class NOTIFIER> void VisitGrid(const float &x, const float &y, float radius, NOTIFIER &notifier);
+
+        // Scan the packed player positions of the loaded cells in radius instead of walking the player lists, see CellPositionIndex
+        template<class NOTIFIER> void VisitPlayersInRange2d(float x, float y, float radius, uint32 phaseMask, NOTIFIER &notifier);
+        template<class NOTIFIER> void VisitPlayersInRange3d(float x, float y, float z, float radius, NOTIFIER &notifier);
+        template<class NOTIFIER> void VisitPlayersInPhase(float x, float y, float radius, uint32 phaseMask, NOTIFIER &notifier);
+        CellPositionIndex const* GetPlayerPositionIndex(CellCoord const& p) const;
+
         CreatureGroupHolderType CreatureGroupHolder;
 
         void UpdateIteratorBack(Player* player);
@@ -468,10 +498,18 @@ class Map : public GridRefManager<NGridType>
 
         float GetWaterOrGroundLevel(float x, float y, float z, float* ground = NULL, bool swim = false) const;
         float GetHeight(uint32 phasemask, float x, float y, float z, bool vmap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
+        // GetHeight(phasemask, ...) of every point, the terrain of points in the same grid is sampled in one go
+        void GetHeights(uint32 phasemask, std::vector<G3D::Vector3> const& points, std::vector<float>& heights, bool vmap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
+        // Raw .map heights of count points, VMAP_INVALID_HEIGHT_VALUE where there is no terrain
+        void GetGridHeights(float const* x, float const* y, float* heights, uint32 count) const;
         bool isInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const;
-        void Balance() { _dynamicTree.balance(); }
-        void RemoveGameObjectModel(const GameObjectModel& model) { _dynamicTree.remove(model); }
-        void InsertGameObjectModel(const GameObjectModel& model) { _dynamicTree.insert(model); }
+        void isInLineOfSight(std::vector<VMAP::LineOfSightRay>& rays) const;
+        void RemoveGameObjectModel(const GameObjectModel& model) { _dynamicTree.remove(model); _lineOfSightCache.Invalidate(model.getBounds()); }
+        void InsertGameObjectModel(const GameObjectModel& model) { _dynamicTree.insert(model); _lineOfSightCache.Invalidate(model.getBounds()); }
+        // oldBounds are the bounds of the model before it moved
+        void RelocateGameObjectModel(const GameObjectModel& model, G3D::AABox const& oldBounds);
+        void InvalidateLineOfSightCache(G3D::AABox const& bounds) { _lineOfSightCache.Invalidate(bounds); }
+        LineOfSightCache const& GetLineOfSightCache() const { return _lineOfSightCache; }
         bool ContainsGameObjectModel(const GameObjectModel& model) const { return _dynamicTree.contains(model);}
         bool getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float &ry, float& rz, float modifyDist);
 
@@ -516,12 +554,22 @@ class Map : public GridRefManager<NGridType>
 
         void UpdateAreaDependentAuras();
 
+        // Called by the grid prefetcher threads: reads the terrain of the grid for LoadMap and
+        // reads the vmap and mmap tiles once so loading them later is served from the file cache
+        void PrepareGridMap(int gx, int gy);
+
     private:
+        void PrefetchGridsAhead(Player* player);
+        void SchedulePrefetch(int gx, int gy);
+        GridMap* TakePreparedGridMap(int gx, int gy);
+
         void LoadMapAndVMap(int gx, int gy);
         void LoadVMap(int gx, int gy);
         void LoadMap(int gx, int gy, bool reload = false);
         void LoadMMap(int gx, int gy);
         GridMap* GetGrid(float x, float y);
+        // GetHeight for a .map height that is already known
+        float SelectHeight(float x, float y, float z, float gridHeight, bool checkVMap, float maxSearchDist) const;
 
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
 
@@ -582,6 +630,7 @@ class Map : public GridRefManager<NGridType>
         uint32 m_unloadTimer;
         float m_VisibleDistance;
         DynamicMapTree _dynamicTree;
+        mutable LineOfSightCache _lineOfSightCache;
 
         MapRefManager m_mapRefManager;
         MapRefManager::iterator m_mapRefIter;
@@ -615,11 +664,28 @@ class Map : public GridRefManager<NGridType>
 
         NGridType* i_grids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
         GridMap* GridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+
+        // Terrain read ahead by the grid prefetcher, only used by maps that are not instanceable
+        struct PreparedGridMap
+        {
+            PreparedGridMap(int x, int y) : gx(x), gy(y), gridMap(NULL) { }
+
+            int gx;
+            int gy;
+            GridMap* gridMap;   // NULL while the prefetch is in flight
+        };
+        std::mutex _preparedGridMapsLock;
+        std::list<PreparedGridMap> _preparedGridMaps;   // oldest first
         std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP*TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
+        std::vector<uint32> marked_cell_ids;    // cells set in marked_cells, in marking order
 
         //these functions used to process player/mob aggro reactions and
         //visibility calculations. Highly optimized for massive calculations
         void ProcessRelocationNotifies(const uint32 diff);
+        bool IsRelocationDue(CellCoord const& p) const;
+
+        bool i_deferVisibility;
+        GuidVector i_deferredVisibility;    // players with gathered visibility changes
 
         bool i_scriptLock;
         std::set<WorldObject*> i_objectsToRemove;
@@ -789,4 +855,35 @@ inline void Map::VisitGrid(const float &x, const float &y, float radius, NOTIFIE
     TypeContainerVisitor<NOTIFIER, GridTypeMapContainer >  grid_object_notifier(notifier);
     cell.Visit(p, grid_object_notifier, *this, radius, x, y);
 }
+
+template<class NOTIFIER>
+inline void Map::VisitPlayersInRange2d(float x, float y, float radius, uint32 phaseMask, NOTIFIER &notifier)
+{
+    // same cell area as Cell::Visit
+    CellArea area = Cell::CalculateCellArea(x, y, std::min(radius, SIZE_OF_GRIDS));
+    for (uint32 cellX = area.low_bound.x_coord; cellX <= area.high_bound.x_coord; ++cellX)
+        for (uint32 cellY = area.low_bound.y_coord; cellY <= area.high_bound.y_coord; ++cellY)
+            if (CellPositionIndex const* index = GetPlayerPositionIndex(CellCoord(cellX, cellY)))
+                index->VisitInRange2d(x, y, radius, phaseMask, notifier);
+}
+
+template<class NOTIFIER>
+inline void Map::VisitPlayersInRange3d(float x, float y, float z, float radius, NOTIFIER &notifier)
+{
+    CellArea area = Cell::CalculateCellArea(x, y, std::min(radius, SIZE_OF_GRIDS));
+    for (uint32 cellX = area.low_bound.x_coord; cellX <= area.high_bound.x_coord; ++cellX)
+        for (uint32 cellY = area.low_bound.y_coord; cellY <= area.high_bound.y_coord; ++cellY)
+            if (CellPositionIndex const* index = GetPlayerPositionIndex(CellCoord(cellX, cellY)))
+                index->VisitInRange3d(x, y, z, radius, notifier);
+}
+
+template<class NOTIFIER>
+inline void Map::VisitPlayersInPhase(float x, float y, float radius, uint32 phaseMask, NOTIFIER &notifier)
+{
+    CellArea area = Cell::CalculateCellArea(x, y, std::min(radius, SIZE_OF_GRIDS));
+    for (uint32 cellX = area.low_bound.x_coord; cellX <= area.high_bound.x_coord; ++cellX)
+        for (uint32 cellY = area.low_bound.y_coord; cellY <= area.high_bound.y_coord; ++cellY)
+            if (CellPositionIndex const* index = GetPlayerPositionIndex(CellCoord(cellX, cellY)))
+                index->VisitInPhase(phaseMask, notifier);
+}
 #endif
@@ -63,6 +63,20 @@ void MapManager::Initialize()
     // Start mtmaps if needed.
     if (num_threads > 0)
         m_updater.activate(num_threads);
+
+    // Prefetch threads only read files, they never run scripts
+    int prefetch_threads(sWorld->getIntConfig(CONFIG_GRID_PREFETCH_THREADS));
+    if (prefetch_threads > 0)
+        m_gridPrefetcher.activate(prefetch_threads);
+
+    // Pathfinding threads only read navmeshes, units take the paths over on their own map thread
+    int pathfinding_threads(sWorld->getIntConfig(CONFIG_PATHFINDING_THREADS));
+    if (pathfinding_threads > 0 && sWorld->getBoolConfig(CONFIG_ENABLE_MMAPS))
+        m_pathfindingService.activate(pathfinding_threads);
+
+    m_pathCorridorCache.Initialize(sWorld->getIntConfig(CONFIG_PATHFINDING_CORRIDOR_CACHE_SIZE));
+
+    m_gridResidency.Initialize();
 }
 
 void MapManager::InitializeVisibilityDistanceInfo()
@@ -260,6 +274,7 @@ void MapManager::Update(uint32 diff)
         iter->second->DelayedUpdate(uint32(i_timer.GetCurrent()));
 
     sObjectAccessor->Update(uint32(i_timer.GetCurrent()));
+    m_gridResidency.Update(uint32(i_timer.GetCurrent()));
 
     i_timer.SetCurrent(0);
 }
@@ -288,8 +303,42 @@ bool MapManager::IsValidMAP(uint32 mapid, bool startUp)
     /// @todo add check for battleground template
 }
 
+void MapManager::TeleportGroupTo(uint32 mapid, GroupTeleportList const& moves, std::vector<Player*>& failed)
+{
+    // instanced maps are created for the group on arrival
+    MapEntry const* entry = sMapStore.LookupEntry(mapid);
+    if (entry && !entry->Instanceable())
+    {
+        Map* map = CreateBaseMap(mapid);
+        std::vector<GridCoord> loaded;
+        for (GroupTeleportList::const_iterator itr = moves.begin(); itr != moves.end(); ++itr)
+        {
+            GridCoord p = Trinity::ComputeGridCoord(itr->second.GetPositionX(), itr->second.GetPositionY());
+            if (std::find(loaded.begin(), loaded.end(), p) != loaded.end())
+                continue;
+
+            loaded.push_back(p);
+            map->LoadGrid(itr->second.GetPositionX(), itr->second.GetPositionY());
+        }
+    }
+
+    // arrivals only queue their visibility update, the players that are added
+    // in the same tick are made visible to each other in one relocation pass
+    for (GroupTeleportList::const_iterator itr = moves.begin(); itr != moves.end(); ++itr)
+        if (!itr->first->TeleportTo(mapid, itr->second.GetPositionX(), itr->second.GetPositionY(), itr->second.GetPositionZ(), itr->second.GetOrientation()))
+            failed.push_back(itr->first);
+}
+
 void MapManager::UnloadAll()
 {
+    // Prefetch requests reference the maps
+    if (m_gridPrefetcher.activated())
+        m_gridPrefetcher.deactivate();
+
+    // Pathfinding threads use the navmeshes that are freed with the maps
+    if (m_pathfindingService.activated())
+        m_pathfindingService.deactivate();
+
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end();)
     {
         iter->second->UnloadAll();
@@ -23,6 +23,10 @@
 #include "Map.h"
 #include "GridStates.h"
 #include "MapUpdater.h"
+#include "GridPrefetcher.h"
+#include "GridResidency.h"
+#include "PathCorridorCache.h"
+#include "PathfindingService.h"
 
 class Transport;
 struct TransportCreatureProto;
@@ -108,6 +112,11 @@ class MapManager
         void DoDelayedMovesAndRemoves();
 
         bool CanPlayerEnter(uint32 mapid, Player* player, bool loginCheck = false);
+
+        typedef std::vector<std::pair<Player*, Position> > GroupTeleportList;
+        // Teleports the players to mapid together, the destination grids are loaded once before the first of them arrives
+        // The players whose teleport was rejected are added to failed
+        void TeleportGroupTo(uint32 mapid, GroupTeleportList const& moves, std::vector<Player*>& failed);
         void InitializeVisibilityDistanceInfo();
 
         /* statistics */
@@ -124,6 +133,10 @@ class MapManager
         void SetNextInstanceId(uint32 nextInstanceId) { _nextInstanceId = nextInstanceId; };
 
         MapUpdater * GetMapUpdater() { return &m_updater; }
+        GridPrefetcher* GetGridPrefetcher() { return &m_gridPrefetcher; }
+        GridResidency* GetGridResidency() { return &m_gridResidency; }
+        PathfindingService* GetPathfindingService() { return &m_pathfindingService; }
+        PathCorridorCache* GetPathCorridorCache() { return &m_pathCorridorCache; }
 
     private:
         typedef std::unordered_map<uint32, Map*> MapMapType;
@@ -149,6 +162,10 @@ class MapManager
         InstanceIds _instanceIds;
         uint32 _nextInstanceId;
         MapUpdater m_updater;
+        GridPrefetcher m_gridPrefetcher;
+        GridResidency m_gridResidency;
+        PathfindingService m_pathfindingService;
+        PathCorridorCache m_pathCorridorCache;
 };
 #define sMapMgr MapManager::instance()
 #endif
@@ -93,8 +93,32 @@ void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T* owner, bool up
     bool forceDest = (owner->GetTypeId() == TYPEID_UNIT && owner->ToCreature()->IsPet()
         && owner->HasUnitState(UNIT_STATE_FOLLOW));
 
-    bool result = i_path->CalculatePath(x, y, z, forceDest);
-    if (!result || (i_path->GetPathType() & PATHFIND_NOPATH))
+    // a path to nearly the same destination is being searched already
+    if (i_path->IsPathPending())
+    {
+        float coalesceDist = sWorld->getRate(RATE_TARGET_POS_RECALCULATION_RANGE);
+        if ((i_path->GetEndPosition() - G3D::Vector3(x, y, z)).squaredLength() <= coalesceDist * coalesceDist)
+            return;
+    }
+
+    if (!i_path->RequestPath(x, y, z, forceDest))
+    {
+        // Cant reach target
+        i_recalculateTravel = true;
+        return;
+    }
+
+    // launched by DoUpdate once the pathfinding threads are done with it
+    if (i_path->IsPathPending())
+        return;
+
+    _launchPath(owner);
+}
+
+template<class T, typename D>
+void TargetedMovementGeneratorMedium<T, D>::_launchPath(T* owner)
+{
+    if (i_path->GetPathType() & PATHFIND_NOPATH)
     {
         // Cant reach target
         i_recalculateTravel = true;
@@ -170,10 +194,21 @@ bool TargetedMovementGeneratorMedium<T, D>::DoUpdate(T* owner, uint32 time_diff)
             targetMoved = !i_target->IsWithinLOSInMap(owner);
     }
 
+    if (i_path && i_path->UpdatePendingPath())
+    {
+        // a path that starts too far behind would pull the unit back
+        G3D::Vector3 const& start = i_path->GetStartPosition();
+        if (owner->GetExactDistSq(start.x, start.y, start.z) > SMOOTH_PATH_STEP_SIZE * SMOOTH_PATH_STEP_SIZE)
+            i_recalculateTravel = true;
+        else
+            _launchPath(owner);
+    }
+
     if (i_recalculateTravel || targetMoved)
         _setTargetLocation(owner, targetMoved);
 
-    if (owner->movespline->Finalized())
+    // not there yet, the path is still being searched
+    if (owner->movespline->Finalized() && (!i_path || !i_path->IsPathPending()))
     {
         static_cast<D*>(this)->MovementInform(owner);
         if (i_angle == 0.f && !owner->HasInArc(0.01f, i_target.getTarget()))
@@ -0,0 +1,88 @@
+/*
+* Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PathCorridorCache.h"
+#include <cstring>
+
+bool PathCorridorCache::Key::operator==(Key const& right) const
+{
+    return navMesh == right.navMesh && startPoly == right.startPoly && endPoly == right.endPoly
+        && includeFlags == right.includeFlags && excludeFlags == right.excludeFlags;
+}
+
+size_t PathCorridorCache::KeyHash::operator()(Key const& key) const
+{
+    size_t hash = size_t(key.navMesh);
+    hash = hash * 31 + size_t(key.startPoly ^ (key.startPoly >> 32));
+    hash = hash * 31 + size_t(key.endPoly ^ (key.endPoly >> 32));
+    hash = hash * 31 + ((key.includeFlags << 16) | key.excludeFlags);
+    return hash;
+}
+
+void PathCorridorCache::Initialize(uint32 maxEntries)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _maxEntries = maxEntries;
+    _entries.clear();
+    _entriesByKey.clear();
+}
+
+uint32 PathCorridorCache::Lookup(dtNavMesh const* navMesh, uint16 includeFlags, uint16 excludeFlags,
+    dtPolyRef startPoly, dtPolyRef endPoly, dtPolyRef* path, uint32 maxPath)
+{
+    Key key = { navMesh, startPoly, endPoly, includeFlags, excludeFlags };
+
+    std::lock_guard<std::mutex> lock(_lock);
+    EntryMap::iterator itr = _entriesByKey.find(key);
+    if (itr == _entriesByKey.end() || itr->second->path.size() > maxPath)
+        return 0;
+
+    // most recently used last
+    _entries.splice(_entries.end(), _entries, itr->second);
+
+    std::vector<dtPolyRef> const& corridor = itr->second->path;
+    memcpy(path, &corridor[0], corridor.size() * sizeof(dtPolyRef));
+    return uint32(corridor.size());
+}
+
+void PathCorridorCache::Store(dtNavMesh const* navMesh, uint16 includeFlags, uint16 excludeFlags, dtPolyRef const* path, uint32 pathSize)
+{
+    if (!pathSize || !_maxEntries)
+        return;
+
+    Key key = { navMesh, path[0], path[pathSize - 1], includeFlags, excludeFlags };
+
+    std::lock_guard<std::mutex> lock(_lock);
+    EntryMap::iterator itr = _entriesByKey.find(key);
+    if (itr != _entriesByKey.end())
+    {
+        itr->second->path.assign(path, path + pathSize);
+        _entries.splice(_entries.end(), _entries, itr->second);
+        return;
+    }
+
+    if (_entriesByKey.size() >= _maxEntries)
+    {
+        _entriesByKey.erase(_entries.front().key);
+        _entries.pop_front();
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.path.assign(path, path + pathSize);
+    _entriesByKey[key] = _entries.insert(_entries.end(), entry);
+}
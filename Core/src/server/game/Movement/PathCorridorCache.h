@@ -0,0 +1,79 @@
+/*
+* Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _PATH_CORRIDOR_CACHE_H_INCLUDED
+#define _PATH_CORRIDOR_CACHE_H_INCLUDED
+
+#include "Define.h"
+#include "DetourNavMesh.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Poly corridors of recently searched paths, shared by all units that path between
+// the same polys with the same filter flags. Used from the map update and pathfinding
+// threads. The corridors are not checked against the navmesh here, tiles that were
+// unloaded since change the salt of their poly refs and the caller has to drop them.
+class PathCorridorCache
+{
+    public:
+
+        PathCorridorCache() : _maxEntries(0) { }
+
+        void Initialize(uint32 maxEntries);
+        bool IsEnabled() const { return _maxEntries != 0; }
+
+        // Copies the corridor from startPoly to endPoly into path and returns its length, 0 if none is stored
+        uint32 Lookup(dtNavMesh const* navMesh, uint16 includeFlags, uint16 excludeFlags,
+            dtPolyRef startPoly, dtPolyRef endPoly, dtPolyRef* path, uint32 maxPath);
+        void Store(dtNavMesh const* navMesh, uint16 includeFlags, uint16 excludeFlags, dtPolyRef const* path, uint32 pathSize);
+
+    private:
+
+        struct Key
+        {
+            dtNavMesh const* navMesh;
+            dtPolyRef startPoly;
+            dtPolyRef endPoly;
+            uint16 includeFlags;
+            uint16 excludeFlags;
+
+            bool operator==(Key const& right) const;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(Key const& key) const;
+        };
+
+        struct Entry
+        {
+            Key key;
+            std::vector<dtPolyRef> path;
+        };
+
+        typedef std::list<Entry> EntryList;
+        typedef std::unordered_map<Key, EntryList::iterator, KeyHash> EntryMap;
+
+        std::mutex _lock;
+        uint32 _maxEntries;
+        EntryList _entries;     // least recently used first
+        EntryMap _entriesByKey;
+};
+
+#endif //_PATH_CORRIDOR_CACHE_H_INCLUDED
@@ -22,6 +22,9 @@
 #include "MMapFactory.h"
 #include "MMapManager.h"
 #include "Log.h"
+#include "MapManager.h"
+#include "PathCorridorCache.h"
+#include "PathfindingService.h"
 
 #include "DetourCommon.h"
 #include "DetourNavMeshQuery.h"
@@ -30,30 +33,43 @@
 PathGenerator::PathGenerator(const Unit* owner) :
     _polyLength(0), _type(PATHFIND_BLANK), _useStraightPath(false),
     _forceDestination(false), _pointPathLimit(MAX_POINT_PATH_LENGTH), _straightLine(false),
-    _endPosition(G3D::Vector3::zero()), _sourceUnit(owner), _navMesh(NULL),
-    _navMeshQuery(NULL)
+    _endPosition(G3D::Vector3::zero()), _sourceUnit(owner), _sourceGuidLow(owner->GetGUIDLow()), _navMesh(NULL),
+    _navMeshQuery(NULL), _detached(false), _finish(PATH_FINISH_NONE), _farFromPoly(false)
 {
     memset(_pathPolyRefs, 0, sizeof(_pathPolyRefs));
 
-    TC_LOG_DEBUG("maps", "++ PathGenerator::PathGenerator for %u \n", _sourceUnit->GetGUIDLow());
+    TC_LOG_DEBUG("maps", "++ PathGenerator::PathGenerator for %u \n", _sourceGuidLow);
 
     uint32 mapId = _sourceUnit->GetMapId();
     if (MMAP::MMapFactory::IsPathfindingEnabled(mapId))
     {
         MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
-        _navMesh = mmap->GetNavMesh(mapId);
-        _navMeshQuery = mmap->GetNavMeshQuery(mapId, _sourceUnit->GetInstanceId());
+        _navMeshData = mmap->GetNavMeshData(mapId);
+        _navMesh = _navMeshData ? _navMeshData->navMesh : NULL;
     }
 
     CreateFilter();
 }
 
+PathGenerator::PathGenerator(PathGenerator const& path) :
+    _polyLength(path._polyLength), _pathPoints(path._pathPoints), _type(path._type),
+    _useStraightPath(path._useStraightPath), _forceDestination(path._forceDestination),
+    _pointPathLimit(path._pointPathLimit), _straightLine(path._straightLine),
+    _startPosition(path._startPosition), _endPosition(path._endPosition), _actualEndPosition(path._actualEndPosition),
+    _corridorStart(path._corridorStart), _corridorEnd(path._corridorEnd),
+    _sourceUnit(path._sourceUnit), _sourceGuidLow(path._sourceGuidLow), _navMesh(path._navMesh),
+    _navMeshQuery(NULL), _navMeshData(path._navMeshData), _filter(path._filter),
+    _detached(true), _finish(PATH_FINISH_NONE), _farFromPoly(false)
+{
+    memcpy(_pathPolyRefs, path._pathPolyRefs, sizeof(_pathPolyRefs));
+}
+
 PathGenerator::~PathGenerator()
 {
-    TC_LOG_DEBUG("maps", "++ PathGenerator::~PathGenerator() for %u \n", _sourceUnit->GetGUIDLow());
+    TC_LOG_DEBUG("maps", "++ PathGenerator::~PathGenerator() for %u \n", _sourceGuidLow);
 }
 
-bool PathGenerator::CalculatePath(float destX, float destY, float destZ, bool forceDest, bool straightLine)
+bool PathGenerator::SetupPath(float destX, float destY, float destZ, bool forceDest, bool straightLine)
 {
     float x, y, z;
     _sourceUnit->GetPosition(x, y, z);
@@ -69,13 +85,54 @@ bool PathGenerator::CalculatePath(float destX, float destY, float destZ, bool fo
 
     _forceDestination = forceDest;
     _straightLine = straightLine;
+    return true;
+}
+
+bool PathGenerator::CalculatePath(float destX, float destY, float destZ, bool forceDest, bool straightLine)
+{
+    // a pending path would replace this one later
+    CancelPendingPath();
+
+    if (!SetupPath(destX, destY, destZ, forceDest, straightLine))
+        return false;
 
-    TC_LOG_DEBUG("maps", "++ PathGenerator::CalculatePath() for %u \n", _sourceUnit->GetGUIDLow());
+    TC_LOG_DEBUG("maps", "++ PathGenerator::CalculatePath() for %u \n", _sourceGuidLow);
+
+    // queries belong to the thread, a map is not always updated by the same one
+    if (_navMesh)
+        _navMeshQuery = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMeshQuery(_sourceUnit->GetMapId());
 
     // make sure navMesh works - we can run on map w/o mmap
     // check if the start and end point have a .mmtile loaded (can we pass via not loaded tile on the way?)
     if (!_navMesh || !_navMeshQuery || _sourceUnit->HasUnitState(UNIT_STATE_IGNORE_PATHFINDING) ||
-        !HaveTile(start) || !HaveTile(dest))
+        !HaveTile(_startPosition) || !HaveTile(_endPosition))
+    {
+        BuildShortcut();
+        _type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+        return true;
+    }
+
+    UpdateFilter();
+
+    BuildPolyPath(_startPosition, _endPosition);
+    return true;
+}
+
+bool PathGenerator::RequestPath(float destX, float destY, float destZ, bool forceDest)
+{
+    PathfindingService* service = sMapMgr->GetPathfindingService();
+    if (!service->activated() || !_navMesh || _sourceUnit->HasUnitState(UNIT_STATE_IGNORE_PATHFINDING))
+        return CalculatePath(destX, destY, destZ, forceDest);
+
+    CancelPendingPath();
+
+    if (!SetupPath(destX, destY, destZ, forceDest, false))
+        return false;
+
+    TC_LOG_DEBUG("maps", "++ PathGenerator::RequestPath() for %u \n", _sourceGuidLow);
+
+    // no tile, no search
+    if (!HaveTile(_startPosition) || !HaveTile(_endPosition))
     {
         BuildShortcut();
         _type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
@@ -84,10 +141,90 @@ bool PathGenerator::CalculatePath(float destX, float destY, float destZ, bool fo
 
     UpdateFilter();
 
-    BuildPolyPath(start, dest);
+    _pendingRequest = service->schedule_path(*this);
+    return true;
+}
+
+void PathGenerator::SearchDetached(dtNavMeshQuery const* query)
+{
+    ASSERT(_detached);
+
+    _navMeshQuery = query;
+    if (!_navMeshQuery)
+    {
+        BuildShortcut();
+        _type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+        return;
+    }
+
+    boost::shared_lock<boost::shared_mutex> lock(_navMeshData->tileLock);
+
+    // the map may have unloaded the tiles since the request
+    if (!HaveTile(_startPosition) || !HaveTile(_endPosition))
+    {
+        BuildShortcut();
+        _type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+        return;
+    }
+
+    BuildPolyPath(_startPosition, _endPosition);
+}
+
+bool PathGenerator::UpdatePendingPath()
+{
+    if (!_pendingRequest || !_pendingRequest->IsDone())
+        return false;
+
+    PathGenerator const& path = _pendingRequest->GetPath();
+    memcpy(_pathPolyRefs, path._pathPolyRefs, sizeof(_pathPolyRefs));
+    _polyLength = path._polyLength;
+    _pathPoints = path._pathPoints;
+    _type = path._type;
+    _actualEndPosition = path._actualEndPosition;
+    _corridorStart = path._corridorStart;
+    _corridorEnd = path._corridorEnd;
+
+    PathFinish finish = path._finish;
+    bool farFromPoly = path._farFromPoly;
+    G3D::Vector3 farFromPolyPoint = path._farFromPolyPoint;
+    _pendingRequest.reset();
+
+    // the parts of BuildPolyPath that need the unit or the terrain of its map
+    if (farFromPoly && CanShortcutFarFromPoly(farFromPolyPoint))
+    {
+        SetActualEndPosition(GetEndPosition());
+        BuildShortcut();
+        _type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+        return true;
+    }
+
+    switch (finish)
+    {
+        case PATH_FINISH_NORMALIZE:
+            NormalizePath();
+            break;
+        case PATH_FINISH_POINT_PATH:
+            FinishPointPath();
+            break;
+        case PATH_FINISH_NO_POLY:
+            BuildMissingPolyPath();
+            break;
+        default:
+            break;
+    }
+
     return true;
 }
 
+void PathGenerator::CancelPendingPath()
+{
+    if (!_pendingRequest)
+        return;
+
+    _pendingRequest->Cancel();
+    _pendingRequest.reset();
+}
+
 dtPolyRef PathGenerator::GetPathPolyByPosition(dtPolyRef const* polyPath, uint32 polyPathSize, float const* point, float* distance) const
 {
     if (!polyPath || !polyPathSize)
@@ -163,6 +300,15 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
     float startPoint[VERTEX_SIZE] = {startPos.y, startPos.z, startPos.x};
     float endPoint[VERTEX_SIZE] = {endPos.y, endPos.z, endPos.x};
 
+    // both ends moved only a little since the last path, move the ends of its corridor
+    // along the mesh instead of looking up the polys and searching again
+    if (MoveCorridor(startPos, endPos, startPoint, endPoint))
+    {
+        TC_LOG_DEBUG("maps", "++ BuildPolyPath :: corridor moved, poly-size %u\n", _polyLength);
+        BuildPointPath(startPoint, endPoint);
+        return;
+    }
+
     dtPolyRef startPoly = GetPolyByLocation(startPoint, &distToStartPoly);
     dtPolyRef endPoly = GetPolyByLocation(endPoint, &distToEndPoly);
 
@@ -172,26 +318,13 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
     if (startPoly == INVALID_POLYREF || endPoly == INVALID_POLYREF)
     {
         TC_LOG_DEBUG("maps", "++ BuildPolyPath :: (startPoly == 0 || endPoly == 0)\n");
-        BuildShortcut();
-        bool path = _sourceUnit->GetTypeId() == TYPEID_UNIT && _sourceUnit->ToCreature()->CanFly();
-
-        bool waterPath = _sourceUnit->GetTypeId() == TYPEID_UNIT && _sourceUnit->ToCreature()->CanSwim();
-        if (waterPath)
+        if (_detached)
         {
-            // Check both start and end points, if they're both in water, then we can *safely* let the creature move
-            for (uint32 i = 0; i < _pathPoints.size(); ++i)
-            {
-                ZLiquidStatus status = _sourceUnit->GetBaseMap()->getLiquidStatus(_pathPoints[i].x, _pathPoints[i].y, _pathPoints[i].z, MAP_ALL_LIQUIDS, NULL);
-                // One of the points is not in the water, cancel movement.
-                if (status == LIQUID_MAP_NO_WATER)
-                {
-                    waterPath = false;
-                    break;
-                }
-            }
+            _finish = PATH_FINISH_NO_POLY;
+            return;
         }
 
-        _type = (path || waterPath) ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+        BuildMissingPolyPath();
         return;
     }
 
@@ -201,44 +334,29 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
     {
         TC_LOG_DEBUG("maps", "++ BuildPolyPath :: farFromPoly distToStartPoly=%.3f distToEndPoly=%.3f\n", distToStartPoly, distToEndPoly);
 
-        bool buildShotrcut = false;
-        if (_sourceUnit->GetTypeId() == TYPEID_UNIT)
+        G3D::Vector3 const& p = (distToStartPoly > 7.0f) ? startPos : endPos;
+        if (_detached)
         {
-            Creature* owner = (Creature*)_sourceUnit;
-
-            G3D::Vector3 const& p = (distToStartPoly > 7.0f) ? startPos : endPos;
-            if (_sourceUnit->GetBaseMap()->IsUnderWater(p.x, p.y, p.z))
-            {
-                TC_LOG_DEBUG("maps", "++ BuildPolyPath :: underWater case\n");
-                if (owner->CanSwim())
-                    buildShotrcut = true;
-            }
-            else
-            {
-                TC_LOG_DEBUG("maps", "++ BuildPolyPath :: flying case\n");
-                if (owner->CanFly())
-                    buildShotrcut = true;
-            }
+            // the map thread drops the path for a shortcut if the unit may fly or swim there
+            _farFromPoly = true;
+            _farFromPolyPoint = p;
         }
-
-        if (buildShotrcut)
+        else if (CanShortcutFarFromPoly(p))
         {
             BuildShortcut();
             _type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
             return;
         }
-        else
-        {
-            float closestPoint[VERTEX_SIZE];
-            // we may want to use closestPointOnPolyBoundary instead
-            if (dtStatusSucceed(_navMeshQuery->closestPointOnPoly(endPoly, endPoint, closestPoint, NULL)))
-            {
-                dtVcopy(endPoint, closestPoint);
-                SetActualEndPosition(G3D::Vector3(endPoint[2], endPoint[0], endPoint[1]));
-            }
 
-            _type = PATHFIND_INCOMPLETE;
+        float closestPoint[VERTEX_SIZE];
+        // we may want to use closestPointOnPolyBoundary instead
+        if (dtStatusSucceed(_navMeshQuery->closestPointOnPoly(endPoly, endPoint, closestPoint, NULL)))
+        {
+            dtVcopy(endPoint, closestPoint);
+            SetActualEndPosition(G3D::Vector3(endPoint[2], endPoint[0], endPoint[1]));
         }
+
+        _type = PATHFIND_INCOMPLETE;
     }
 
     // *** poly path generating logic ***
@@ -274,9 +392,9 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
             if (_pathPolyRefs[pathStartIndex] == INVALID_POLYREF)
             {
                 TC_LOG_ERROR("maps", "Invalid poly ref in BuildPolyPath. _polyLength: %u, pathStartIndex: %u,"
-                                     " startPos: %s, endPos: %s, mapid: %u",
+                                     " startPos: %s, endPos: %s, unit: %u",
                                      _polyLength, pathStartIndex, startPos.toString().c_str(), endPos.toString().c_str(),
-                                     _sourceUnit->GetMapId());
+                                     _sourceGuidLow);
 
                 break;
             }
@@ -392,7 +510,7 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
             // this is probably an error state, but we'll leave it
             // and hopefully recover on the next Update
             // we still need to copy our preffix
-            TC_LOG_ERROR("maps", "%u's Path Build failed: 0 length path", _sourceUnit->GetGUIDLow());
+            TC_LOG_ERROR("maps", "%u's Path Build failed: 0 length path", _sourceGuidLow);
         }
 
         TC_LOG_DEBUG("maps", "++  m_polyLength=%u prefixPolyLength=%u suffixPolyLength=%u \n", _polyLength, prefixPolyLength, suffixPolyLength);
@@ -437,6 +555,11 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
                 return;
             }
         }
+        else if ((_polyLength = GetCachedCorridor(startPoly, endPoly)))
+        {
+            // another unit searched between these polys not long ago
+            dtResult = DT_SUCCESS;
+        }
         else
         {
             dtResult = _navMeshQuery->findPath(
@@ -448,12 +571,16 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
                             _pathPolyRefs,     // [out] path
                             (int*)&_polyLength,
                             MAX_PATH_LENGTH);   // max number of polygons in output path
+
+            PathCorridorCache* corridorCache = sMapMgr->GetPathCorridorCache();
+            if (corridorCache->IsEnabled() && dtStatusSucceed(dtResult) && _polyLength && _pathPolyRefs[_polyLength - 1] == endPoly)
+                corridorCache->Store(_navMesh, _filter.getIncludeFlags(), _filter.getExcludeFlags(), _pathPolyRefs, _polyLength);
         }
 
         if (!_polyLength || dtStatusFailed(dtResult))
         {
             // only happens if we passed bad data to findPath(), or navmesh is messed up
-            TC_LOG_ERROR("maps", "%u's Path Build failed: 0 length path", _sourceUnit->GetGUIDLow());
+            TC_LOG_ERROR("maps", "%u's Path Build failed: 0 length path", _sourceGuidLow);
             BuildShortcut();
             _type = PATHFIND_NOPATH;
             return;
@@ -466,10 +593,83 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
     else
         _type = PATHFIND_INCOMPLETE;
 
+    _corridorStart = startPos;
+    _corridorEnd = endPos;
+
     // generate the point-path out of our up-to-date poly-path
     BuildPointPath(startPoint, endPoint);
 }
 
+bool PathGenerator::MoveCorridor(G3D::Vector3 const& startPos, G3D::Vector3 const& endPos, float const* startPoint, float const* endPoint)
+{
+    // only a complete poly path is moved, like dtPathCorridor does
+    float maxMoveSq = PATH_CORRIDOR_MOVE_DIST * PATH_CORRIDOR_MOVE_DIST;
+    if (_straightLine || _type != PATHFIND_NORMAL || _polyLength < 2 ||
+        Dist3DSqr(startPos, _corridorStart) > maxMoveSq || Dist3DSqr(endPos, _corridorEnd) > maxMoveSq)
+        return false;
+
+    // polys of tiles that were unloaded meanwhile are gone
+    for (uint32 i = 0; i < _polyLength; ++i)
+        if (!_navMeshQuery->isValidPolyRef(_pathPolyRefs[i], &_filter))
+            return false;
+
+    static uint32 const MAX_VISIT_POLY = 16;
+    dtPolyRef visited[MAX_VISIT_POLY];
+    uint32 nvisited = 0;
+    float fromPoint[VERTEX_SIZE];
+    float result[VERTEX_SIZE];
+
+    // work on a copy, the path is left as it was if either end can not be moved
+    dtPolyRef corridor[MAX_PATH_LENGTH];
+    uint32 corridorLength = _polyLength;
+    memcpy(corridor, _pathPolyRefs, _polyLength * sizeof(dtPolyRef));
+
+    // move the start along the mesh and put the polys it crossed in front of the corridor
+    float corridorStart[VERTEX_SIZE] = {_corridorStart.y, _corridorStart.z, _corridorStart.x};
+    if (dtStatusFailed(_navMeshQuery->closestPointOnPoly(corridor[0], corridorStart, fromPoint, NULL)) ||
+        dtStatusFailed(_navMeshQuery->moveAlongSurface(corridor[0], fromPoint, startPoint, &_filter, result, visited, (int*)&nvisited, MAX_VISIT_POLY)) ||
+        !nvisited || !InRangeYZX(result, startPoint, SMOOTH_PATH_SLOP, 1000.0f))
+        return false;
+
+    corridorLength = FixupCorridor(corridor, corridorLength, MAX_PATH_LENGTH, visited, nvisited);
+
+    // same for the end, the polys it crossed go to the back
+    nvisited = 0;
+    float corridorEnd[VERTEX_SIZE] = {_corridorEnd.y, _corridorEnd.z, _corridorEnd.x};
+    if (dtStatusFailed(_navMeshQuery->closestPointOnPoly(corridor[corridorLength - 1], corridorEnd, fromPoint, NULL)) ||
+        dtStatusFailed(_navMeshQuery->moveAlongSurface(corridor[corridorLength - 1], fromPoint, endPoint, &_filter, result, visited, (int*)&nvisited, MAX_VISIT_POLY)) ||
+        !nvisited || !InRangeYZX(result, endPoint, SMOOTH_PATH_SLOP, 1000.0f))
+        return false;
+
+    corridorLength = MergeCorridorEnd(corridor, corridorLength, MAX_PATH_LENGTH, visited, nvisited);
+
+    // both ends on one poly, BuildPolyPath makes a shortcut of that
+    if (corridorLength < 2)
+        return false;
+
+    memcpy(_pathPolyRefs, corridor, corridorLength * sizeof(dtPolyRef));
+    _polyLength = corridorLength;
+    _corridorStart = startPos;
+    _corridorEnd = endPos;
+    return true;
+}
+
+uint32 PathGenerator::GetCachedCorridor(dtPolyRef startPoly, dtPolyRef endPoly)
+{
+    PathCorridorCache* corridorCache = sMapMgr->GetPathCorridorCache();
+    if (!corridorCache->IsEnabled())
+        return 0;
+
+    uint32 length = corridorCache->Lookup(_navMesh, _filter.getIncludeFlags(), _filter.getExcludeFlags(), startPoly, endPoly, _pathPolyRefs, MAX_PATH_LENGTH);
+
+    // polys of tiles that were unloaded since the corridor was stored are gone
+    for (uint32 i = 0; i < length; ++i)
+        if (!_navMeshQuery->isValidPolyRef(_pathPolyRefs[i], &_filter))
+            return 0;
+
+    return length;
+}
+
 void PathGenerator::BuildPointPath(const float *startPoint, const float *endPoint)
 {
     float pathPoints[MAX_POINT_PATH_LENGTH*VERTEX_SIZE];
@@ -548,10 +748,21 @@ void PathGenerator::BuildPointPath(const float *startPoint, const float *endPoin
     for (uint32 i = 0; i < pointCount; ++i)
         _pathPoints[i] = G3D::Vector3(pathPoints[i*VERTEX_SIZE+2], pathPoints[i*VERTEX_SIZE], pathPoints[i*VERTEX_SIZE+1]);
 
+    if (_detached)
+    {
+        _finish = PATH_FINISH_POINT_PATH;
+        return;
+    }
+
+    FinishPointPath();
+}
+
+void PathGenerator::FinishPointPath()
+{
     NormalizePath();
 
     // first point is always our current location - we need the next one
-    SetActualEndPosition(_pathPoints[pointCount-1]);
+    SetActualEndPosition(_pathPoints.back());
 
     // force the given destination, if needed
     if (_forceDestination &&
@@ -572,13 +783,12 @@ void PathGenerator::BuildPointPath(const float *startPoint, const float *endPoin
         _type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
     }
 
-    TC_LOG_DEBUG("maps", "++ PathGenerator::BuildPointPath path type %d size %d poly-size %d\n", _type, pointCount, _polyLength);
+    TC_LOG_DEBUG("maps", "++ PathGenerator::BuildPointPath path type %d size %u poly-size %d\n", _type, uint32(_pathPoints.size()), _polyLength);
 }
 
 void PathGenerator::NormalizePath()
 {
-    for (uint32 i = 0; i < _pathPoints.size(); ++i)
-        _sourceUnit->UpdateAllowedPositionZ(_pathPoints[i].x, _pathPoints[i].y, _pathPoints[i].z);
+    _sourceUnit->UpdateAllowedPositionZ(_pathPoints);
 }
 
 void PathGenerator::BuildShortcut()
@@ -594,11 +804,54 @@ void PathGenerator::BuildShortcut()
     _pathPoints[0] = GetStartPosition();
     _pathPoints[1] = GetActualEndPosition();
 
-    NormalizePath();
+    if (_detached)
+        _finish = PATH_FINISH_NORMALIZE;
+    else
+        NormalizePath();
 
     _type = PATHFIND_SHORTCUT;
 }
 
+void PathGenerator::BuildMissingPolyPath()
+{
+    BuildShortcut();
+    bool path = _sourceUnit->GetTypeId() == TYPEID_UNIT && _sourceUnit->ToCreature()->CanFly();
+
+    bool waterPath = _sourceUnit->GetTypeId() == TYPEID_UNIT && _sourceUnit->ToCreature()->CanSwim();
+    if (waterPath)
+    {
+        // Check both start and end points, if they're both in water, then we can *safely* let the creature move
+        for (uint32 i = 0; i < _pathPoints.size(); ++i)
+        {
+            ZLiquidStatus status = _sourceUnit->GetBaseMap()->getLiquidStatus(_pathPoints[i].x, _pathPoints[i].y, _pathPoints[i].z, MAP_ALL_LIQUIDS, NULL);
+            // One of the points is not in the water, cancel movement.
+            if (status == LIQUID_MAP_NO_WATER)
+            {
+                waterPath = false;
+                break;
+            }
+        }
+    }
+
+    _type = (path || waterPath) ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+}
+
+bool PathGenerator::CanShortcutFarFromPoly(G3D::Vector3 const& p) const
+{
+    if (_sourceUnit->GetTypeId() != TYPEID_UNIT)
+        return false;
+
+    Creature const* owner = _sourceUnit->ToCreature();
+    if (_sourceUnit->GetBaseMap()->IsUnderWater(p.x, p.y, p.z))
+    {
+        TC_LOG_DEBUG("maps", "++ BuildPolyPath :: underWater case\n");
+        return owner->CanSwim();
+    }
+
+    TC_LOG_DEBUG("maps", "++ BuildPolyPath :: flying case\n");
+    return owner->CanFly();
+}
+
 void PathGenerator::CreateFilter()
 {
     uint16 includeFlags = 0;
@@ -678,6 +931,42 @@ bool PathGenerator::HaveTile(const G3D::Vector3& p) const
     return (_navMesh->getTileAt(tx, ty, 0) != NULL);
 }
 
+uint32 PathGenerator::MergeCorridorEnd(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited)
+{
+    int32 furthestPath = -1;
+    int32 furthestVisited = -1;
+
+    // Find the first polygon of the path that the end visited.
+    for (uint32 i = 0; i < npath; ++i)
+    {
+        bool found = false;
+        for (int32 j = nvisited-1; j >= 0; --j)
+        {
+            if (path[i] == visited[j])
+            {
+                furthestPath = i;
+                furthestVisited = j;
+                found = true;
+            }
+        }
+        if (found)
+            break;
+    }
+
+    // If no intersection found just return current path.
+    if (furthestPath == -1 || furthestVisited == -1)
+        return npath;
+
+    // Replace the path after it with the rest of visited.
+    uint32 ppos = furthestPath + 1;
+    uint32 vpos = furthestVisited + 1;
+    uint32 count = std::min(nvisited - vpos, maxPath - ppos);
+    if (count)
+        memcpy(path + ppos, visited + vpos, count * sizeof(dtPolyRef));
+
+    return ppos + count;
+}
+
 uint32 PathGenerator::FixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited)
 {
     int32 furthestPath = -1;
@@ -23,9 +23,16 @@
 #include "DetourNavMesh.h"
 #include "DetourNavMeshQuery.h"
 #include "MoveSplineInitArgs.h"
+#include <memory>
 
+class PathRequest;
 class Unit;
 
+namespace MMAP
+{
+    struct MMapData;
+}
+
 // 74*4.0f=296y  number_of_points*interval = max_path_len
 // this is way more than actual evade range
 // I think we can safely cut those down even more
@@ -35,6 +42,9 @@ class Unit;
 #define SMOOTH_PATH_STEP_SIZE   4.0f
 #define SMOOTH_PATH_SLOP        0.3f
 
+// ends moved less than this are moved along the corridor of the previous path
+#define PATH_CORRIDOR_MOVE_DIST 1.0f
+
 #define VERTEX_SIZE       3
 #define INVALID_POLYREF   0
 
@@ -49,6 +59,15 @@ enum PathType
     PATHFIND_SHORT          = 0x20,   // path is longer or equal to its limited path length
 };
 
+// Work left to the map thread by a path searched on the pathfinding threads
+enum PathFinish
+{
+    PATH_FINISH_NONE        = 0,
+    PATH_FINISH_NORMALIZE   = 1,    // shortcut points need their height
+    PATH_FINISH_POINT_PATH  = 2,    // point path needs its height and the forced destination
+    PATH_FINISH_NO_POLY     = 3,    // start or end has no poly, flying and swimming decide the path
+};
+
 class PathGenerator
 {
     public:
@@ -59,6 +78,16 @@ class PathGenerator
         // return: true if new path was calculated, false otherwise (no change needed)
         bool CalculatePath(float destX, float destY, float destZ, bool forceDest = false, bool straightLine = false);
 
+        // Same as CalculatePath, but the search runs on the pathfinding threads when they are active.
+        // The previous path is kept until UpdatePendingPath takes the new one over on a later update.
+        // return: false if no path can be requested
+        bool RequestPath(float destX, float destY, float destZ, bool forceDest = false);
+
+        // return: true if the path of the pending request was taken over
+        bool UpdatePendingPath();
+        bool IsPathPending() const { return _pendingRequest != nullptr; }
+        void CancelPendingPath();
+
         // option setters - use optional
         void SetUseStraightPath(bool useStraightPath) { _useStraightPath = useStraightPath; }
         void SetPathLengthLimit(float distance) { _pointPathLimit = std::min<uint32>(uint32(distance/SMOOTH_PATH_STEP_SIZE), MAX_POINT_PATH_LENGTH); }
@@ -75,6 +104,10 @@ class PathGenerator
         void ReducePathLenghtByDist(float dist); // path must be already built
 
     private:
+        friend class PathRequest;
+
+        // copies are searched by the pathfinding threads, they must not touch the unit or its map
+        PathGenerator(PathGenerator const& path);
 
         dtPolyRef _pathPolyRefs[MAX_PATH_LENGTH];   // array of detour polygon references
         uint32 _polyLength;                         // number of polygons in the path
@@ -90,17 +123,29 @@ class PathGenerator
         G3D::Vector3 _startPosition;        // {x, y, z} of current location
         G3D::Vector3 _endPosition;          // {x, y, z} of the destination
         G3D::Vector3 _actualEndPosition;    // {x, y, z} of the closest possible point to given destination
+        G3D::Vector3 _corridorStart;        // {x, y, z} of the start the poly path was built for
+        G3D::Vector3 _corridorEnd;          // {x, y, z} of the end the poly path was built for
 
         Unit const* const _sourceUnit;          // the unit that is moving
+        uint32 _sourceGuidLow;
         dtNavMesh const* _navMesh;              // the nav mesh
         dtNavMeshQuery const* _navMeshQuery;    // the nav mesh query used to find the path
+        std::shared_ptr<MMAP::MMapData> _navMeshData;   // owns _navMesh and the tile lock the pathfinding threads hold shared
 
         dtQueryFilter _filter;  // use single filter for all movements, update it when needed
 
+        std::shared_ptr<PathRequest> _pendingRequest;
+        bool _detached;                 // searched by a pathfinding thread
+        PathFinish _finish;             // left to the map thread by a detached search
+        bool _farFromPoly;              // the detached search ignored that flying or swimming may shortcut
+        G3D::Vector3 _farFromPolyPoint;
+
         void SetStartPosition(G3D::Vector3 const& point) { _startPosition = point; }
         void SetEndPosition(G3D::Vector3 const& point) { _actualEndPosition = point; _endPosition = point; }
         void SetActualEndPosition(G3D::Vector3 const& point) { _actualEndPosition = point; }
         void NormalizePath();
+        bool SetupPath(float destX, float destY, float destZ, bool forceDest, bool straightLine);
+        void SearchDetached(dtNavMeshQuery const* query);
 
         void Clear()
         {
@@ -117,8 +162,13 @@ class PathGenerator
         bool HaveTile(G3D::Vector3 const& p) const;
 
         void BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 const& endPos);
+        bool MoveCorridor(G3D::Vector3 const& startPos, G3D::Vector3 const& endPos, float const* startPoint, float const* endPoint);
+        uint32 GetCachedCorridor(dtPolyRef startPoly, dtPolyRef endPoly);
         void BuildPointPath(float const* startPoint, float const* endPoint);
         void BuildShortcut();
+        void BuildMissingPolyPath();
+        bool CanShortcutFarFromPoly(G3D::Vector3 const& p) const;
+        void FinishPointPath();
 
         NavTerrain GetNavTerrain(float x, float y, float z);
         void CreateFilter();
@@ -126,6 +176,7 @@ class PathGenerator
 
         // smooth path aux functions
         uint32 FixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited);
+        uint32 MergeCorridorEnd(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited);
         bool GetSteerTarget(float const* startPos, float const* endPos, float minTargetDist, dtPolyRef const* path, uint32 pathSize, float* steerPos,
                             unsigned char& steerPosFlag, dtPolyRef& steerPosRef);
         dtStatus FindSmoothPath(float const* startPos, float const* endPos,
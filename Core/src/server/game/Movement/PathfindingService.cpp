@@ -0,0 +1,119 @@
+/*
+* Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PathfindingService.h"
+#include "Log.h"
+#include "MMapManager.h"
+
+void PathRequest::Search(dtNavMeshQuery const* query)
+{
+    _path.SearchDetached(query);
+    _done = true;
+}
+
+void PathfindingService::activate(size_t num_threads)
+{
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        _workerThreads.push_back(std::thread(&PathfindingService::WorkerThread, this));
+    }
+}
+
+void PathfindingService::deactivate()
+{
+    _cancelationToken = true;
+
+    // generators still waiting keep their previous path
+    _queue.Cancel();
+
+    for (auto& thread : _workerThreads)
+    {
+        thread.join();
+    }
+
+    _workerThreads.clear();
+}
+
+std::shared_ptr<PathRequest> PathfindingService::schedule_path(PathGenerator const& path)
+{
+    std::shared_ptr<PathRequest> request = std::make_shared<PathRequest>(path);
+    _queue.Push(request);
+    return request;
+}
+
+bool PathfindingService::activated()
+{
+    return _workerThreads.size() > 0;
+}
+
+dtNavMeshQuery const* PathfindingService::GetQuery(NavMeshQueryMap& queries, std::shared_ptr<MMAP::MMapData> const& navMeshData)
+{
+    // drop the queries of unloaded navmeshes, the next navmesh may be allocated at the same address
+    for (NavMeshQueryMap::iterator itr = queries.begin(); itr != queries.end();)
+    {
+        if (itr->second.navMeshData.expired())
+        {
+            dtFreeNavMeshQuery(itr->second.query);
+            itr = queries.erase(itr);
+        }
+        else
+            ++itr;
+    }
+
+    dtNavMesh const* navMesh = navMeshData->navMesh;
+    NavMeshQueryMap::const_iterator itr = queries.find(navMesh);
+    if (itr != queries.end())
+        return itr->second.query;
+
+    dtNavMeshQuery* query = dtAllocNavMeshQuery();
+    ASSERT(query);
+    if (dtStatusFailed(query->init(navMesh, 1024)))
+    {
+        dtFreeNavMeshQuery(query);
+        TC_LOG_ERROR("maps", "PathfindingService: Failed to initialize dtNavMeshQuery");
+        query = NULL;
+    }
+
+    NavMeshQuery& entry = queries[navMesh];
+    entry.navMeshData = navMeshData;
+    entry.query = query;
+    return query;
+}
+
+void PathfindingService::WorkerThread()
+{
+    NavMeshQueryMap queries;
+
+    while (1)
+    {
+        std::shared_ptr<PathRequest> request;
+
+        _queue.WaitAndPop(request);
+
+        if (_cancelationToken)
+            break;
+
+        // the generator asked for another path meanwhile
+        if (!request || request->IsCanceled())
+            continue;
+
+        request->Search(GetQuery(queries, request->GetNavMeshData()));
+    }
+
+    for (NavMeshQueryMap::const_iterator itr = queries.begin(); itr != queries.end(); ++itr)
+        dtFreeNavMeshQuery(itr->second.query);
+}
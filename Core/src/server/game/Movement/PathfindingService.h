@@ -0,0 +1,90 @@
+/*
+* Copyright (C) 2008-2014 TrinityCore <http://www.trinitycore.org/>
+*
+* This program is free software; you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the
+* Free Software Foundation; either version 2 of the License, or (at your
+* option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+* more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _PATHFINDING_SERVICE_H_INCLUDED
+#define _PATHFINDING_SERVICE_H_INCLUDED
+
+#include "Define.h"
+#include "PathGenerator.h"
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ProducerConsumerQueue.h"
+
+// Search of a detached copy of a PathGenerator, shared by the generator and the queue.
+// The generator drops its reference when it asks for another path or goes away.
+class PathRequest
+{
+    public:
+
+        explicit PathRequest(PathGenerator const& path) : _path(path), _done(false), _canceled(false) { }
+
+        void Search(dtNavMeshQuery const* query);
+
+        PathGenerator const& GetPath() const { return _path; }
+        std::shared_ptr<MMAP::MMapData> const& GetNavMeshData() const { return _path._navMeshData; }
+
+        bool IsDone() const { return _done; }
+        bool IsCanceled() const { return _canceled; }
+        void Cancel() { _canceled = true; }
+
+    private:
+
+        PathGenerator _path;
+        std::atomic<bool> _done;
+        std::atomic<bool> _canceled;
+};
+
+// Searches the paths of chasing and following units on worker threads, every
+// thread has its own dtNavMeshQuery per navmesh since those are not thread safe.
+// A request keeps its navmesh alive, a map may unload it while the request waits.
+class PathfindingService
+{
+    public:
+
+        PathfindingService() : _cancelationToken(false) {}
+        ~PathfindingService() { };
+
+        std::shared_ptr<PathRequest> schedule_path(PathGenerator const& path);
+
+        void activate(size_t num_threads);
+
+        void deactivate();
+
+        bool activated();
+
+    private:
+
+        struct NavMeshQuery
+        {
+            std::weak_ptr<MMAP::MMapData> navMeshData;  // expires once the navmesh is unloaded and no request holds it
+            dtNavMeshQuery* query;
+        };
+
+        typedef std::unordered_map<dtNavMesh const*, NavMeshQuery> NavMeshQueryMap;
+
+        ProducerConsumerQueue<std::shared_ptr<PathRequest> > _queue;
+
+        std::vector<std::thread> _workerThreads;
+        std::atomic<bool> _cancelationToken;
+
+        void WorkerThread();
+        static dtNavMeshQuery const* GetQuery(NavMeshQueryMap& queries, std::shared_ptr<MMAP::MMapData> const& navMeshData);
+};
+
+#endif //_PATHFINDING_SERVICE_H_INCLUDED
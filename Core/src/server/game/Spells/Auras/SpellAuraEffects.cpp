@@ -416,6 +416,21 @@ void AuraEffect::GetApplicationList(std::list<AuraApplication*> & applicationLis
     }
 }
 
+void AuraEffect::SetAmount(int32 amount)
+{
+    m_amount = amount;
+    m_canBeRecalculated = false;
+    UpdateTargetAuraModifierTotals();
+}
+
+void AuraEffect::UpdateTargetAuraModifierTotals() const
+{
+    // targets cache the totals of each aura type, they have to be rebuilt with the new amount
+    Aura::ApplicationMap const& targetMap = GetBase()->GetApplicationMap();
+    for (Aura::ApplicationMap::const_iterator appIter = targetMap.begin(); appIter != targetMap.end(); ++appIter)
+        appIter->second->GetTarget()->_InvalidateAuraModifierTotals(GetAuraType());
+}
+
 int32 AuraEffect::CalculateAmount(Unit* caster)
 {
     // default amount calculation
@@ -623,7 +638,10 @@ void AuraEffect::ChangeAmount(int32 newAmount, bool mark, bool onStackOrReapply)
     if (handleMask & AURA_EFFECT_HANDLE_CHANGE_AMOUNT)
     {
         if (!mark)
+        {
             m_amount = newAmount;
+            UpdateTargetAuraModifierTotals();
+        }
         else
             SetAmount(newAmount);
         CalculateSpellMod();
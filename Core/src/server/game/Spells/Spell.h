@@ -204,6 +204,14 @@ enum SpellState
     SPELL_STATE_DELAYED   = 5
 };
 
+// Line of sight of a target, shared by the effects that check it the same way
+enum SpellLOSCheck
+{
+    SPELL_LOS_NOT_CHECKED,
+    SPELL_LOS_IN_SIGHT,
+    SPELL_LOS_OUT_OF_SIGHT
+};
+
 enum SpellEffectHandleMode
 {
     SPELL_EFFECT_HANDLE_LAUNCH,
@@ -351,6 +359,12 @@ class Spell
         Spell(Unit* caster, SpellInfo const* info, TriggerCastFlags triggerFlags, ObjectGuid originalCasterGUID = ObjectGuid::Empty, bool skipCheck = false);
         ~Spell();
 
+        // Spell objects are recycled through a per thread free list
+        static void* operator new(size_t size);
+        static void operator delete(void* p);
+        // Spells created, how many of them reused a pooled object and target container (re)allocations since startup
+        static void GetAllocationStats(uint64& created, uint64& reused, uint64& targetAllocations);
+
         void InitExplicitTargets(SpellCastTargets const& targets);
         void SelectExplicitTargets();
 
@@ -419,7 +433,8 @@ class Spell
         void WriteSpellGoTargets(WorldPacket* data);
         void WriteAmmoToPacket(WorldPacket* data);
 
-        bool CheckEffectTarget(Unit const* target, uint32 eff, Position const* losPosition) const;
+        bool CheckEffectTarget(Unit const* target, uint32 eff, Position const* losPosition, SpellLOSCheck& losCheck) const;
+        bool IgnoresLineOfSight() const;
         bool CanAutoCast(Unit* target);
         void CheckSrc() { if (!m_targets.HasSrc()) m_targets.SetSrc(*m_caster); }
         void CheckDst() { if (!m_targets.HasDst()) m_targets.SetDst(*m_caster); }
@@ -589,7 +604,7 @@ class Spell
             bool   scaleAura:1;
             int32  damage;
         };
-        std::list<TargetInfo> m_UniqueTargetInfo;
+        std::vector<TargetInfo> m_UniqueTargetInfo;
         uint8 m_channelTargetEffectMask;                        // Mask req. alive targets
 
         struct GOTargetInfo
@@ -599,18 +614,18 @@ class Spell
             uint8  effectMask:8;
             bool   processed:1;
         };
-        std::list<GOTargetInfo> m_UniqueGOTargetInfo;
+        std::vector<GOTargetInfo> m_UniqueGOTargetInfo;
 
         struct ItemTargetInfo
         {
             Item  *item;
             uint8 effectMask;
         };
-        std::list<ItemTargetInfo> m_UniqueItemInfo;
+        std::vector<ItemTargetInfo> m_UniqueItemInfo;
 
         SpellDestination m_destTargets[MAX_SPELL_EFFECTS];
 
-        void AddUnitTarget(Unit* target, uint32 effectMask, bool checkIfValid = true, bool implicit = true, Position const* losPosition = nullptr);
+        void AddUnitTarget(Unit* target, uint32 effectMask, bool checkIfValid = true, bool implicit = true, Position const* losPosition = nullptr, bool losChecked = false);
         void AddGOTarget(GameObject* target, uint32 effectMask);
         void AddItemTarget(Item* item, uint32 effectMask);
         void AddDestTarget(SpellDestination const& dest, uint32 effIndex);
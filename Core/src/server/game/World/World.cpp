@@ -1111,6 +1111,13 @@ void World::LoadConfigSettings(bool reload)
     m_visibility_notify_periodInInstances = sConfigMgr->GetIntDefault("Visibility.Notify.Period.InInstances",   DEFAULT_VISIBILITY_NOTIFY_PERIOD);
     m_visibility_notify_periodInBGArenas = sConfigMgr->GetIntDefault("Visibility.Notify.Period.InBGArenas",    DEFAULT_VISIBILITY_NOTIFY_PERIOD);
 
+    m_float_configs[CONFIG_VISIBILITY_RELOCATION_LOWER_LIMIT] = sConfigMgr->GetFloatDefault("Visibility.RelocationLowerLimit", 0.0f);
+    if (m_float_configs[CONFIG_VISIBILITY_RELOCATION_LOWER_LIMIT] < 0.0f)
+    {
+        TC_LOG_ERROR("server.loading", "Visibility.RelocationLowerLimit (%f) can't be negative. Set to 0.", m_float_configs[CONFIG_VISIBILITY_RELOCATION_LOWER_LIMIT]);
+        m_float_configs[CONFIG_VISIBILITY_RELOCATION_LOWER_LIMIT] = 0.0f;
+    }
+
     ///- Load the CharDelete related config options
     m_int_configs[CONFIG_CHARDELETE_METHOD] = sConfigMgr->GetIntDefault("CharDelete.Method", 0);
     m_int_configs[CONFIG_CHARDELETE_MIN_LEVEL] = sConfigMgr->GetIntDefault("CharDelete.MinLevel", 0);
@@ -1146,6 +1153,13 @@ void World::LoadConfigSettings(bool reload)
     TC_LOG_INFO("server.loading", "WORLD: MMap data directory is: %smmaps", m_dataPath.c_str());
 
     m_bool_configs[CONFIG_VMAP_INDOOR_CHECK] = sConfigMgr->GetBoolDefault("vmap.enableIndoorCheck", 0);
+    m_int_configs[CONFIG_LOS_CACHE_TTL] = sConfigMgr->GetIntDefault("LineOfSightCache.TTL", 0);
+    m_float_configs[CONFIG_LOS_CACHE_GRID_SIZE] = sConfigMgr->GetFloatDefault("LineOfSightCache.GridSize", 0.5f);
+    if (m_float_configs[CONFIG_LOS_CACHE_GRID_SIZE] <= 0.0f)
+    {
+        TC_LOG_ERROR("server.loading", "LineOfSightCache.GridSize (%f) must be positive. Set to 0.5.", m_float_configs[CONFIG_LOS_CACHE_GRID_SIZE]);
+        m_float_configs[CONFIG_LOS_CACHE_GRID_SIZE] = 0.5f;
+    }
     bool enableIndoor = sConfigMgr->GetBoolDefault("vmap.enableIndoorCheck", true);
     bool enableLOS = sConfigMgr->GetBoolDefault("vmap.enableLOS", true);
     bool enableHeight = sConfigMgr->GetBoolDefault("vmap.enableHeight", true);
@@ -1181,6 +1195,13 @@ void World::LoadConfigSettings(bool reload)
     m_int_configs[CONFIG_INTERVAL_LOG_UPDATE] = sConfigMgr->GetIntDefault("RecordUpdateTimeDiffInterval", 60000);
     m_int_configs[CONFIG_MIN_LOG_UPDATE] = sConfigMgr->GetIntDefault("MinRecordUpdateTimeDiff", 100);
     m_int_configs[CONFIG_NUMTHREADS] = sConfigMgr->GetIntDefault("MapUpdate.Threads", 1);
+    m_int_configs[CONFIG_GRID_PREFETCH_THREADS] = sConfigMgr->GetIntDefault("GridPrefetch.Threads", 0);
+    m_int_configs[CONFIG_GRID_PREFETCH_LOOKAHEAD] = sConfigMgr->GetIntDefault("GridPrefetch.Lookahead", 5000);
+    m_int_configs[CONFIG_GRID_RESIDENCY_MAX_IDLE_GRIDS] = sConfigMgr->GetIntDefault("GridResidency.MaxIdleGrids", 0);
+    m_int_configs[CONFIG_GRID_RESIDENCY_STATS_INTERVAL] = sConfigMgr->GetIntDefault("GridResidency.StatsInterval", 0);
+    m_int_configs[CONFIG_PATHFINDING_THREADS] = sConfigMgr->GetIntDefault("Pathfinding.Threads", 0);
+    m_int_configs[CONFIG_PATHFINDING_CORRIDOR_CACHE_SIZE] = sConfigMgr->GetIntDefault("Pathfinding.CorridorCacheSize", 0);
+    m_int_configs[CONFIG_CREATURE_MOVEMENT_LOD_INTERVAL] = sConfigMgr->GetIntDefault("Creature.MovementLod.Interval", 0);
     m_int_configs[CONFIG_MAX_RESULTS_LOOKUP_COMMANDS] = sConfigMgr->GetIntDefault("Command.LookupMaxResults", 0);
 
     // Warden
@@ -1809,6 +1830,9 @@ void World::SetInitialWorldSettings()
     TC_LOG_INFO("server.loading", "Loading Transports...");
     sTransportMgr->SpawnContinentTransports();
 
+    TC_LOG_INFO("server.loading", "Loading hot grids...");
+    sMapMgr->GetGridResidency()->LoadHotGrids();
+
     ///- Initialize Warden
     TC_LOG_INFO("server.loading", "Loading Warden Checks...");
     sWardenCheckMgr->LoadWardenChecks();
@@ -178,6 +178,8 @@ enum WorldFloatConfigs
     CONFIG_STATS_LIMITS_PARRY,
     CONFIG_STATS_LIMITS_BLOCK,
     CONFIG_STATS_LIMITS_CRIT,
+    CONFIG_VISIBILITY_RELOCATION_LOWER_LIMIT,
+    CONFIG_LOS_CACHE_GRID_SIZE,
     FLOAT_CONFIG_VALUE_COUNT
 };
 
@@ -293,6 +295,14 @@ enum WorldIntConfigs
     CONFIG_ENABLE_SINFO_LOGIN,
     CONFIG_PLAYER_ALLOW_COMMANDS,
     CONFIG_NUMTHREADS,
+    CONFIG_GRID_PREFETCH_THREADS,
+    CONFIG_GRID_PREFETCH_LOOKAHEAD,
+    CONFIG_GRID_RESIDENCY_MAX_IDLE_GRIDS,
+    CONFIG_GRID_RESIDENCY_STATS_INTERVAL,
+    CONFIG_LOS_CACHE_TTL,
+    CONFIG_PATHFINDING_THREADS,
+    CONFIG_PATHFINDING_CORRIDOR_CACHE_SIZE,
+    CONFIG_CREATURE_MOVEMENT_LOD_INTERVAL,
     CONFIG_LOGDB_CLEARINTERVAL,
     CONFIG_LOGDB_CLEARTIME,
     CONFIG_CLIENTCACHE_VERSION,
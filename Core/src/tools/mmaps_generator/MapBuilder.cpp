@@ -172,41 +172,28 @@ namespace MMAP
     {
         while (1)
         {
-            uint32 mapId;
+            TileBuildTask task;
 
-            _queue.WaitAndPop(mapId);
+            _queue.WaitAndPop(task);
 
             if (_cancelationToken)
                 return;
 
-            buildMap(mapId);
+            buildQueuedTile(task);
         }
     }
 
-    void MapBuilder::buildAllMaps(int threads)
+    void MapBuilder::startWorkers(int threads)
     {
+        _cancelationToken = false;
         for (int i = 0; i < threads; ++i)
         {
             _workerThreads.push_back(std::thread(&MapBuilder::WorkerThread, this));
         }
+    }
 
-        m_tiles.sort([](MapTiles a, MapTiles b)
-        {
-            return a.m_tiles->size() > b.m_tiles->size();
-        });
-
-        for (TileList::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
-        {
-            uint32 mapId = it->m_mapId;
-            if (!shouldSkipMap(mapId))
-            {
-                if (threads > 0)
-                    _queue.Push(mapId);
-                else
-                    buildMap(mapId);
-            }
-        }
-
+    void MapBuilder::stopWorkers()
+    {
         while (!_queue.Empty())
         {
             std::this_thread::sleep_for(std::chrono::milliseconds(1000));
@@ -216,10 +203,32 @@ namespace MMAP
 
         _queue.Cancel();
 
+        // workers finish the tile they are building before they leave
         for (auto& thread : _workerThreads)
         {
             thread.join();
         }
+        _workerThreads.clear();
+    }
+
+    void MapBuilder::buildAllMaps(int threads)
+    {
+        startWorkers(threads);
+
+        // the tiles of the largest maps go first, so they are spread over all workers from the start
+        m_tiles.sort([](MapTiles a, MapTiles b)
+        {
+            return a.m_tiles->size() > b.m_tiles->size();
+        });
+
+        for (TileList::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
+        {
+            uint32 mapId = it->m_mapId;
+            if (!shouldSkipMap(mapId))
+                queueMap(mapId, threads);
+        }
+
+        stopWorkers();
     }
 
     /**************************************************************************/
@@ -366,12 +375,16 @@ namespace MMAP
     }
 
     /**************************************************************************/
-    void MapBuilder::buildMap(uint32 mapID)
+    void MapBuilder::buildMap(uint32 mapID, int threads)
     {
-#ifndef __APPLE__
-        //printf("[Thread %u] Building map %03u:\n", uint32(ACE_Thread::self()), mapID);
-#endif
+        startWorkers(threads);
+        queueMap(mapID, threads);
+        stopWorkers();
+    }
 
+    /**************************************************************************/
+    void MapBuilder::queueMap(uint32 mapID, int threads)
+    {
         std::set<uint32>* tiles = getTileList(mapID);
 
         // make sure we process maps which don't have tiles
@@ -387,36 +400,69 @@ namespace MMAP
                     tiles->insert(StaticMapTree::packTileID(i, j));
         }
 
-        if (!tiles->empty())
+        if (tiles->empty())
         {
-            // build navMesh
-            dtNavMesh* navMesh = NULL;
-            buildNavMesh(mapID, navMesh);
-            if (!navMesh)
-            {
-                printf("[Map %03i] Failed creating navmesh!\n", mapID);
-                return;
-            }
+            printf("[Map %03i] Complete!\n", mapID);
+            return;
+        }
 
-            // now start building mmtiles for each tile
-            printf("[Map %03i] We have %u tiles.                          \n", mapID, (unsigned int)tiles->size());
-            for (std::set<uint32>::iterator it = tiles->begin(); it != tiles->end(); ++it)
-            {
-                uint32 tileX, tileY;
+        // tiles of an earlier run that are complete and valid are kept
+        std::vector<uint32> pendingTiles;
+        for (std::set<uint32>::iterator it = tiles->begin(); it != tiles->end(); ++it)
+        {
+            uint32 tileX, tileY;
 
-                // unpack tile coords
-                StaticMapTree::unpackTileID((*it), tileX, tileY);
+            // unpack tile coords
+            StaticMapTree::unpackTileID((*it), tileX, tileY);
 
-                if (shouldSkipTile(mapID, tileX, tileY))
-                    continue;
+            if (!shouldSkipTile(mapID, tileX, tileY))
+                pendingTiles.push_back(*it);
+        }
 
-                buildTile(mapID, tileX, tileY, navMesh);
-            }
+        // build navMesh
+        dtNavMesh* navMesh = NULL;
+        buildNavMesh(mapID, navMesh);
+        if (!navMesh)
+        {
+            printf("[Map %03i] Failed creating navmesh!\n", mapID);
+            return;
+        }
 
+        printf("[Map %03i] We have %u tiles, %u of them to build.                          \n", mapID, (unsigned int)tiles->size(), (unsigned int)pendingTiles.size());
+        if (pendingTiles.empty())
+        {
             dtFreeNavMesh(navMesh);
+            printf("[Map %03i] Complete!\n", mapID);
+            return;
         }
 
-        printf("[Map %03i] Complete!\n", mapID);
+        // now start building mmtiles for each tile
+        MapBuildState* state = new MapBuildState(mapID, navMesh, uint32(pendingTiles.size()));
+        for (std::vector<uint32>::const_iterator it = pendingTiles.begin(); it != pendingTiles.end(); ++it)
+        {
+            TileBuildTask task;
+            task.map = state;
+            StaticMapTree::unpackTileID((*it), task.tileX, task.tileY);
+
+            if (threads > 0)
+                _queue.Push(task);
+            else
+                buildQueuedTile(task);
+        }
+    }
+
+    /**************************************************************************/
+    void MapBuilder::buildQueuedTile(TileBuildTask const& task)
+    {
+        MapBuildState* state = task.map;
+        buildTile(state->mapId, task.tileX, task.tileY, state->navMesh);
+
+        if (--state->remainingTiles == 0)
+        {
+            printf("[Map %03i] Complete!\n", state->mapId);
+            dtFreeNavMesh(state->navMesh);
+            delete state;
+        }
     }
 
     /**************************************************************************/
@@ -821,6 +867,9 @@ namespace MMAP
                 break;
             }
 
+            // held until the tile is removed again, so no other worker can add a tile or link to this one while it is in the navmesh
+            std::lock_guard<std::mutex> navMeshGuard(_navMeshLock);
+
             dtTileRef tileRef = 0;
             printf("%s Adding tile to navmesh...\n", tileString);
             // DT_TILE_FREE_DATA tells detour to unallocate memory when the tile
@@ -832,14 +881,16 @@ namespace MMAP
                 break;
             }
 
-            // file output
+            // file output, written under another name first so an interrupted build never leaves a tile that looks complete
             char fileName[255];
+            char tempFileName[255];
             sprintf(fileName, "mmaps/%03u%02i%02i.mmtile", mapID, tileY, tileX);
-            FILE* file = fopen(fileName, "wb");
+            sprintf(tempFileName, "%s.tmp", fileName);
+            FILE* file = fopen(tempFileName, "wb");
             if (!file)
             {
                 char message[1024];
-                sprintf(message, "[Map %03i] Failed to open %s for writing!\n", mapID, fileName);
+                sprintf(message, "[Map %03i] Failed to open %s for writing!\n", mapID, tempFileName);
                 perror(message);
                 navMesh->removeTile(tileRef, NULL, NULL);
                 break;
@@ -857,6 +908,14 @@ namespace MMAP
             fwrite(navData, sizeof(unsigned char), navDataSize, file);
             fclose(file);
 
+            remove(fileName);
+            if (rename(tempFileName, fileName) != 0)
+            {
+                char message[1024];
+                sprintf(message, "[Map %03i] Failed to rename %s to %s!\n", mapID, tempFileName, fileName);
+                perror(message);
+            }
+
             // now that tile is written to disk, we can unload it
             navMesh->removeTile(tileRef, NULL, NULL);
         }
@@ -1000,10 +1059,16 @@ namespace MMAP
 
         MmapTileHeader header;
         int count = fread(&header, sizeof(MmapTileHeader), 1, file);
+        fseek(file, 0, SEEK_END);
+        long fileSize = ftell(file);
         fclose(file);
         if (count != 1)
             return false;
 
+        // a tile cut short by an interrupted build is built again
+        if (fileSize != long(sizeof(MmapTileHeader) + header.size))
+            return false;
+
         if (header.mmapMagic != MMAP_MAGIC || header.dtVersion != uint32(DT_NAVMESH_VERSION))
             return false;
 
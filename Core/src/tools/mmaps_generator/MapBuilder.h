@@ -24,6 +24,7 @@
 #include <map>
 #include <list>
 #include <atomic>
+#include <mutex>
 #include <thread>
 
 #include "TerrainBuilder.h"
@@ -73,6 +74,23 @@ namespace MMAP
         rcPolyMeshDetail* dmesh;
     };
 
+    // navmesh of a map whose tiles are being built, the worker that builds the last tile frees it
+    struct MapBuildState
+    {
+        MapBuildState(uint32 id, dtNavMesh* mesh, uint32 tiles) : mapId(id), navMesh(mesh), remainingTiles(tiles) {}
+
+        uint32 mapId;
+        dtNavMesh* navMesh;
+        std::atomic<uint32> remainingTiles;
+    };
+
+    struct TileBuildTask
+    {
+        MapBuildState* map;
+        uint32 tileX;
+        uint32 tileY;
+    };
+
     class MapBuilder
     {
         public:
@@ -88,7 +106,7 @@ namespace MMAP
             ~MapBuilder();
 
             // builds all mmap tiles for the specified map id (ignores skip settings)
-            void buildMap(uint32 mapID);
+            void buildMap(uint32 mapID, int threads);
             void buildMeshFromFile(char* name);
 
             // builds an mmap tile for the specified map and its mesh
@@ -100,6 +118,13 @@ namespace MMAP
             void WorkerThread();
 
         private:
+            void startWorkers(int threads);
+            void stopWorkers();
+
+            // queues the tiles of a map that are not built yet, or builds them right away without workers
+            void queueMap(uint32 mapID, int threads);
+            void buildQueuedTile(TileBuildTask const& task);
+
             // detect maps and tiles
             void discoverTiles();
             std::set<uint32>* getTileList(uint32 mapID);
@@ -143,8 +168,11 @@ namespace MMAP
             rcContext* m_rcContext;
 
             std::vector<std::thread> _workerThreads;
-            ProducerConsumerQueue<uint32> _queue;
+            ProducerConsumerQueue<TileBuildTask> _queue;
             std::atomic<bool> _cancelationToken;
+
+            // tiles of one map are built in parallel, detour does not allow adding and removing them concurrently
+            std::mutex _navMeshLock;
     };
 }
 
@@ -3,12 +3,9 @@ print("\n---------------")
 print("Loaded game")
 print("---------------")
 
-local NUM_PLAYERS_TO_START_GAME = 3
-local gameId = 1
---			1    2     3       4     5			6		7
--- Game = { id, name, active, host, {players}, state, data }
-local games = {}
-local entities = {}
+-- Match lifecycle (queue, countdown, spawn points, logout and host loss) is handled by the core,
+-- see RegisterMatchEvent. This file keeps the addon protocol and the game rules.
+local MATCH_STATE_QUEUED = 1
 
 function JoinGame(plr, msg)
 	-- Filter unwanted chars
@@ -17,22 +14,19 @@ function JoinGame(plr, msg)
 			message[i] = '_'
 		end
 	end
-	if plr:GetData("GAME") ~= nil then
-		plr:SendBroadcastMessage("ERROR: You are already in game: " .. tostring(plr:GetData("GAME")))
+	local current = GetPlayerMatch(plr)
+	if current then
+		plr:SendBroadcastMessage("ERROR: You are already in game: " .. tostring(GetMatchInfo(current)))
 		return
 	end
-	for _,v in pairs(games) do
-		if v[2] == msg then
-			if v[3] then
-				plr:SendBroadcastMessage("You cannot join a game that is already in progress!")
-				return
-			end
-			table.insert(v[5], plr:GetGUID())
-			plr:SetData("GAME", msg)
-			plr:SendBroadcastMessage("You have joined: " .. msg)
-			return
-		end
+	if not GetMatchByName(msg) then
+		return
 	end
+	if not JoinMatch(msg, plr) then
+		plr:SendBroadcastMessage("You cannot join a game that is already in progress!")
+		return
+	end
+	plr:SendBroadcastMessage("You have joined: " .. msg)
 end
 
 function leaveGame(plr, msg)
@@ -42,13 +36,9 @@ function leaveGame(plr, msg)
 			message[i] = '_'
 		end
 	end
-	for k,v in pairs(games) do
-		if v[2] == msg then
-			games[k][5][plr:GetGUID()] = nil
-			plr:SetData("GAME", nil)
-			plr:SendBroadcastMessage("You have left: " .. msg)
-			return
-		end
+	local matchId = GetMatchByName(msg)
+	if matchId and matchId == GetPlayerMatch(plr) and LeaveMatch(plr) then
+		plr:SendBroadcastMessage("You have left: " .. msg)
 	end
 end
 
@@ -59,26 +49,26 @@ function CREATEGAME(plr, msg)
 			message[i] = '_'
 		end
 	end
-	if plr:GetData("GAME") ~= nil then
-		plr:SendBroadcastMessage("ERROR: You are already in game: " .. tostring(plr:GetData("GAME")))
+	local current = GetPlayerMatch(plr)
+	if current then
+		plr:SendBroadcastMessage("ERROR: You are already in game: " .. tostring(GetMatchInfo(current)))
 		return
 	end
-	-- Insert a new record
-	local newGame = {gameId, msg, false, plr:GetGUID(), {plr:GetGUID()}}
-	gameId = gameId + 1
-	plr:SetData("GAME", msg)
-	table.insert(games, newGame)
+	if not CreateMatch(msg, plr) then
+		plr:SendBroadcastMessage("ERROR: Could not create the game, the name is taken or the server is full.")
+	end
 end
 
 function GetTheGamesAvailable(plr, msg)
 	local gameNames = "GAMES"
-	for _,v in pairs(games) do
-		if v[3] then
+	for _,matchId in ipairs(GetMatches()) do
+		local name, _, state = GetMatchInfo(matchId)
+		if state ~= MATCH_STATE_QUEUED then
 			gameNames = gameNames .. "-2-"
 		else
 			gameNames = gameNames .. "-1-"
 		end
-		gameNames = gameNames .. v[2]
+		gameNames = gameNames .. name
 	end
 	sendAddonMessage(plr, gameNames, 1)
 end
@@ -91,152 +81,70 @@ function PLRSLB(plr, msg)
 			message[i] = '_'
 		end
 	end
-	if plr:GetData("GAME") == nil then
+	if not GetPlayerMatch(plr) then
 		plr:SendBroadcastMessage("ERROR: You are not in a game.")
 		return
 	end
-	for _,v in pairs(games) do
-		if v[2] == msg then
-			local peopleInGame = "PLAYERS"
-			for _,k in pairs(v[5]) do
-				if GetPlayerByGUID(k) then
-					peopleInGame = peopleInGame .. "-" .. GetPlayerByGUID(k):GetName()
-				end
-			end
-			sendAddonMessage(plr, peopleInGame, 2)
-			return
+	local matchId = GetMatchByName(msg)
+	if matchId then
+		local peopleInGame = "PLAYERS"
+		for _,k in pairs(GetPlayersByGUID(GetMatchPlayers(matchId))) do
+			peopleInGame = peopleInGame .. "-" .. k:GetName()
 		end
+		sendAddonMessage(plr, peopleInGame, 2)
 	end
 end
 
 ------------------------------------------
 
-local function updateAllGames()
-	for k,game in pairs(games) do
---print("Handling: {" .. tostring(game[1]) .. ", " .. tostring(game[2]) .. ", " .. tostring(game[3]) .. ", " .. tostring(game[4]) .. ", " .. tostring(game[5]) .. "}")
-		if game[3] then -- active
-			handleActiveGame(game)
-		else
-			handleInactiveGame(game, k)
-		end
+local function MATCH_EVENT_ON_JOIN(event, matchId, plr)
+	-- Queued players wait in the lobby, a join that filled the match was already sent to the arena
+	local _, _, state = GetMatchInfo(matchId)
+	if state == MATCH_STATE_QUEUED and plr:GetMap():GetMapId() ~= 13 then
+		plr:Teleport(13, 0.0, 0.0, 0.0, 0.0)
 	end
 end
 
-CreateLuaEvent(updateAllGames, 1000, 0)
-
-function handleActiveGame(game)
-	local state = game[6]
-	if state == 1 then
-		local locations = game[7]
-		local temp = {}
-		local count = 1
-		for _,plr in pairs(game[5]) do
-			plr = GetPlayerByGUID(plr)
-			if plr then
-				local obj = PerformIngameSpawn(2, 184719, 800, 0, locations[count][1], locations[count][2], locations[count][3], 0, false, 0, game[1])
-				obj:SetScale(0.05)
-				--obj:SetByteValue(6 + 0x000B, 0, 1)
-				--obj:SetByteValue(6 + 0x000B, 3, 100)
-				obj:SetUInt32Value(0x0006 + 0x0003, 0x1) -- untargetable
-				count = count + 1
-				table.insert(temp, obj)
-			end
-		end
-		game[7] = temp
-		state = state + 1
-	elseif state < 30 then -- spawning
-		state = state + 1
-	elseif state == 30 then
-		state = 31
-		for _,obj in pairs(game[7]) do
-			if obj then
-				obj:Despawn(0)
-			end
-		end
-		for _,plr in pairs(game[5]) do
-			plr = GetPlayerByGUID(plr)
-			if plr then
-				plr:PlaySoundToPlayer(3439)
-			end
-		end
+RegisterMatchEvent(2, MATCH_EVENT_ON_JOIN)
+
+local function MATCH_EVENT_ON_START(event, matchId, phaseMask)
+	local players = GetMatchPlayers(matchId)
+	SendBroadcastToGUIDs("The game will start in 30 seconds!", players)
+	for _,rPlr in pairs(GetPlayersByGUID(players)) do
+		sendAddonMessage(rPlr, "STARTINGGAME", 3) -- interface
 	end
-	game[6] = state
+	-- Set time to 7am
+	local p = CreatePacket(66, 12)
+	p:WriteULong(GetHungerGamesInitialTime()) -- time
+	p:WriteFloat(1.20000024) -- speed
+	p:WriteULong(0)
+	SendPacketToGUIDs(p, players)
 end
 
-function handleInactiveGame(game, k)
-	-- Handle bad host
-	if not GetPlayerByGUID(game[4]) then -- host
-		for _,plr in pairs(game[5]) do -- all players
-			local rPlr = GetPlayerByGUID(plr)
-			if rPlr then
-				sendAddonMessage(rPlr, "RESET", 3)
-				rPlr:SendBroadcastMessage("You have been removed from the queue because the host went offline.")
-				rPlr:SetData("GAME", nil)
-			end
-		end
-		games[k] = nil
-		return
-	end
-	-- Check we have enough players
-	for kk,plr in pairs(game[5]) do
-		local rPlr = GetPlayerByGUID(plr)
-		if not rPlr then
-			game[5][kk] = nil
-		else
-			if rPlr:GetMap():GetMapId() ~= 13 then
-				rPlr:Teleport(13, 0.0, 0.0, 0.0, 0.0)
-			end
-		end
-	end
-	if #game[5] >= NUM_PLAYERS_TO_START_GAME then
-		handleStartGame(game)
-	end
+RegisterMatchEvent(4, MATCH_EVENT_ON_START)
+
+local function MATCH_EVENT_ON_COUNTDOWN_END(event, matchId)
+	-- SMSG_PLAY_SOUND
+	local p = CreatePacket(722, 4)
+	p:WriteULong(3439)
+	SendPacketToGUIDs(p, GetMatchPlayers(matchId))
 end
 
-function handleStartGame(game)
-	game[3] = true -- active game now
-	local locations = {
-		{-4088.836, 3880.989, 6.6, 3.952591},
-		{-4105.4, 3897.5744, 6.6, 3.913325},
-		{-4121.458, 3914.43, 6.6, 3.960447},
-		{-4088.836, 3880.989, 6.6, 3.952591},
-		{-4105.4, 3897.5744, 6.6, 3.913325},
-		{-4121.458, 3914.43, 6.6, 3.960447},
-		{-4088.836, 3880.989, 6.6, 3.952591},
-		{-4105.4, 3897.5744, 6.6, 3.913325},
-		{-4121.458, 3914.43, 6.6, 3.960447},
-		{-4088.836, 3880.989, 6.6, 3.952591}
-	}
-	game[6] = 1 -- state
-	locations = shuffled(locations)
-	local count = 1
-	for _,plr in pairs(game[5]) do
-		local rPlr = GetPlayerByGUID(plr)
-		if rPlr then
-			rPlr:SendBroadcastMessage("The game will start in 30 seconds!")
-			rPlr:SetPhaseMask(game[1]) -- currently phase = game ID
-			rPlr:Teleport(800, locations[count][1], locations[count][2], locations[count][3], locations[count][4])
-			sendAddonMessage(rPlr, "STARTINGGAME", 3) -- interface
-			-- Set time to 7am
-			local p = CreatePacket(66, 12)
-			p:WriteULong(GetHungerGamesInitialTime()) -- time
-			p:WriteFloat(1.20000024) -- speed
-			p:WriteULong(0)
-			count = count + 1
-			rPlr:SendPacket(p)
-		end
+RegisterMatchEvent(5, MATCH_EVENT_ON_COUNTDOWN_END)
+
+local function MATCH_EVENT_ON_DISBAND(event, matchId, reason)
+	local players = GetMatchPlayers(matchId)
+	for _,rPlr in pairs(GetPlayersByGUID(players)) do
+		sendAddonMessage(rPlr, "RESET", 3)
+	end
+	if reason == 1 then -- host lost
+		SendBroadcastToGUIDs("You have been removed from the queue because the host went offline.", players)
+	elseif reason == 3 then -- shutdown/reload
+		SendBroadcastToGUIDs("The game has been ended by the server.", players)
 	end
-	game[7] = locations
 end
 
--- Return array in random order
-function shuffled(tab)
-	local n, order, res = #tab, {}, {}
-	for i=1,n do order[i] = { rnd = math.random(), idx = i } end
-	table.sort(order, function(a,b) return a.rnd < b.rnd end)
-	for i=1,n do res[i] = tab[order[i].idx] end
-	return res
-end
+RegisterMatchEvent(6, MATCH_EVENT_ON_DISBAND)
 
 local function PLAYER_EVENT_ON_KILL_PLAYER(event, killer, killed)
 	if killer and killed then
@@ -247,25 +155,6 @@ end
 RegisterPlayerEvent(6, PLAYER_EVENT_ON_KILL_PLAYER)
 RegisterPlayerEvent(8, PLAYER_EVENT_ON_KILL_PLAYER) -- death by creature
 
-local function PLAYER_EVENT_ON_LOGOUT(event, player)
-	if not player then
-		return
-	end
-	local data = player:GetData("GAME")
-	if not data then
-		return
-	end
-	player:SetData("GAME", nil)
-	for k,v in pairs(games) do
-		if v[2] == data then
-			table.remove(v[5], player:GetGUID())
-			return
-		end
-	end
-end
-
-RegisterPlayerEvent(4, PLAYER_EVENT_ON_LOGOUT)
-
 
 
 
@@ -39,7 +39,7 @@ local function PLAYER_EVENT_ON_REPOP(event, player)
 	player:SendBroadcastMessage("Repop")
 	player:ResurrectPlayer()
 	player:Teleport(13, 0.0, 0.0, 0.0, 0.0, 0.0)
-	player:SetData("GAME", nil)
+	LeaveMatch(player)
 	sendAddonMessage(player, "RESET", 3)
 end
 